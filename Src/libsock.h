@@ -7,10 +7,26 @@
 #include <exception>
 #include <system_error>
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <streambuf>
+#include <istream>
 #include <vector>
+#include <map>
+#include <deque>
 #include <type_traits>
 #include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <cstddef>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #ifndef _CONSTEXPR_IF
 #if defined( __cpp_if_constexpr )
@@ -55,12 +71,51 @@
 #include <sys/socket.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
+#include <netinet/tcp.h>
+#include <linux/errqueue.h>
+#include <sys/sendfile.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <linux/filter.h>
+#include <linux/memfd.h>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined( __has_include )
+#if __has_include( <linux/io_uring.h> )
+#define _LIBSOCK_HAS_IO_URING
+#include <linux/io_uring.h>
+#endif
+#endif
 
 #else
 #error Unknown target OS
 
 #endif
 
+#if defined( OS_LINUX ) && defined( __cpp_impl_coroutine ) && defined( __has_include )
+#if __has_include( <coroutine> )
+#define _LIBSOCK_HAS_COROUTINES
+#include <coroutine>
+#endif
+#endif
+
+#if defined( __has_include )
+#if __has_include( <span> )
+#include <span>
+#endif
+#if __has_include( <charconv> )
+#include <charconv>
+#if defined( __cpp_lib_to_chars )
+#define _LIBSOCK_HAS_TO_CHARS
+#endif
+#endif
+#endif
+
 #define _LIBSOCK ::libsock::
 
 #define _LIBSOCK_CHECK_ARG_NOT_NULL( ARG ) \
@@ -71,6 +126,10 @@
     if( (ARG) == (VAL) ) \
         throw std::invalid_argument( #ARG " cannot be " #VAL ); 
 
+#define _LIBSOCK_CHECK_ARG_NOT_GREATER( ARG, VAL ) \
+    if( (ARG) > (VAL) ) \
+        throw std::invalid_argument( #ARG " cannot be greater than " #VAL );
+
 
 namespace libsock
 {
@@ -109,6 +168,26 @@ inline std::basic_string<wchar_t> _To_string( _Ty _Val,
     }
 
 
+// STRUCT TEMPLATE _Is_charconv_number
+template<typename _Ty>
+struct _Is_charconv_number
+    : std::integral_constant<bool, std::is_floating_point<_Ty>::value
+        || (std::is_integral<_Ty>::value
+            && !std::is_same<_Ty, bool>::value
+            && !std::is_same<_Ty, char>::value
+            && !std::is_same<_Ty, signed char>::value
+            && !std::is_same<_Ty, unsigned char>::value
+            && !std::is_same<_Ty, wchar_t>::value
+            && !std::is_same<_Ty, char16_t>::value
+            && !std::is_same<_Ty, char32_t>::value
+#if defined( __cpp_char8_t )
+            && !std::is_same<_Ty, char8_t>::value
+#endif
+            )>
+    {   // arithmetic type formatted as number by to_chars, standard streams format bool and characters differently
+    };
+
+
 // CLASS TEMPLATE _Socket_flags_helper
 template<typename _FlagTy, typename _StorageTy>
 class _Socket_flags_helper
@@ -229,11 +308,15 @@ using ::send;
 using ::sendto;
 using ::recv;
 using ::recvfrom;
+#if defined( OS_LINUX )
+using ::accept4;
+#endif
 using ::getprotobyname;
 using ::getaddrinfo;
 using ::freeaddrinfo;
 
 using ::memcpy;
+using ::memmove;
 using ::memset;
 using ::strlen;
 using ::strcpy;
@@ -247,7 +330,12 @@ using ::std::max;
 
 #if defined( OS_WINDOWS )
 using ::closesocket;
+inline int poll( pollfd* _Fds, unsigned long _Count, int _Timeout ) noexcept
+    {   // poll alias for windows
+    return ::WSAPoll( _Fds, _Count, _Timeout );
+    }
 #elif defined( OS_LINUX )
+using ::poll;
 inline int closesocket( _Socket_handle _Socket ) noexcept
     {   // closesocket alias for linux
     return ::close( _Socket );
@@ -315,6 +403,13 @@ public:
     };
 
 
+_NODISCARD inline const std::error_category& socket_category() noexcept
+    {   // get libsock error category object
+    static const _Socket_error_category _Category;
+    return _Category;
+    }
+
+
 // CLASS socket_exception
 class socket_exception
     : public std::system_error
@@ -323,17 +418,29 @@ class socket_exception
 
 public:
     inline socket_exception( int _Errval )
-        : _MyBase( _Errval, _Socket_error_category{} )
+        : _MyBase( _Errval, socket_category() )
         {   // construct basic socket exception
         }
 
     inline socket_exception( int _Errval, const char* _Message )
-        : _MyBase( _Errval, _Socket_error_category{}, _Message )
+        : _MyBase( _Errval, socket_category(), _Message )
         {   // construct basic socket exception with own message
         }
     };
 
 
+template<typename _Ty>
+inline _Ty _Throw_if_failed( _Ty _Retval )
+    {   // throw exception if native call result _Retval indicates error
+    if( _Retval < 0 )
+        { // assume that all negative return values indicate error
+        throw socket_exception( __impl::geterror(
+            static_cast<int>(_Retval) ) );
+        }
+    return _Retval;
+    }
+
+
 // STRUCT TEMPLATE big_endian
 template<typename _Ty>
 struct big_endian
@@ -580,7 +687,12 @@ enum class socket_opt
     reuse_addr          = SO_REUSEADDR,     // allow local address reuse
     keep_alive          = SO_KEEPALIVE,     // keep connections alive
     broadcast           = SO_BROADCAST,     // permit sending of broadcast messages
+    error               = SO_ERROR,         // get and clear pending socket error
     //loopback            = SO_USELOOPBACK,   // bypass hardware when possible
+#if defined( OS_LINUX )
+    reuse_port          = SO_REUSEPORT,     // allow multiple sockets bound to the same address
+    zerocopy            = SO_ZEROCOPY,      // allow sending with socket_send_flags::zerocopy
+#endif
     };
 
 template<>
@@ -631,57 +743,67 @@ struct _Socket_opt_level<socket_opt_ip>
     };
 
 
-// STRUCT _Socket_address_base
-struct _Socket_address_base
+// ENUM CLASS socket_opt_tcp
+enum class socket_opt_tcp
     {
-public:
-    inline _Socket_address_base( socket_address_family _Family ) noexcept
-        : _MyFamily( _Family )
-        {   // construct socket address base instance
-        }
+    unknown             = -1,
+    no_delay            = TCP_NODELAY,      // disable Nagle's algorithm
+#if defined( OS_LINUX )
+    cork                = TCP_CORK,         // send only full segments until uncorked
+#endif
+    };
 
-    inline virtual ~_Socket_address_base() noexcept
-        {   // destroy socket address base instance
-        }
-    
-public:
-    _NODISCARD inline socket_address_family get_family() const noexcept
-        {   // get socket address family
-        return this->_MyFamily;
-        }
+template<>
+struct _Socket_opt_level<socket_opt_tcp>
+    {
+    static constexpr int value = IPPROTO_TCP;
+    };
 
-    _NODISCARD virtual const sockaddr* get_native_sockaddr() const noexcept = 0;
-    _NODISCARD virtual const size_t get_native_sockaddr_size() const noexcept = 0;
 
-protected:
-    socket_address_family _MyFamily;
+#if defined( OS_LINUX )
+// ENUM CLASS socket_opt_udp
+enum class socket_opt_udp
+    {
+    unknown             = -1,
+    segment             = UDP_SEGMENT,      // split sent buffers into datagrams of this size (GSO)
+    gro                 = UDP_GRO,          // receive coalesced datagrams (GRO)
     };
 
+template<>
+struct _Socket_opt_level<socket_opt_udp>
+    {
+    static constexpr int value = IPPROTO_UDP;
+    };
+#endif
+
 
 // STRUCT TEMPLATE socket_address
 template<socket_address_family _Family, typename _SockAddrTy>
 struct socket_address
-    : public _Socket_address_base
     {
 public:
     inline socket_address() noexcept
-        : _Socket_address_base( _Family )
         {   // construct uninitialized socket address wrapper
         }
 
     inline socket_address( const _SockAddrTy* _Sockaddr ) noexcept
-        : _Socket_address_base( _Family ), _MySockaddr()
+        : _MySockaddr()
         {   // construct socket address wrapper
         if( _Sockaddr != nullptr )
             _MySockaddr = (*_Sockaddr);
         }
 
-    _NODISCARD inline virtual const sockaddr* get_native_sockaddr() const noexcept override
+    _NODISCARD inline socket_address_family get_family() const noexcept
+        {   // get socket address family
+        return _Family;
+        }
+
+    _NODISCARD inline const sockaddr* get_native_sockaddr() const noexcept
         {   // get native sockaddr structure
         return reinterpret_cast<const sockaddr*>(&_MySockaddr);
         }
 
-    _NODISCARD inline virtual const size_t get_native_sockaddr_size() const noexcept override
+    _NODISCARD inline size_t get_native_sockaddr_size() const noexcept
         {   // get native sockaddr structure size
         return sizeof( _MySockaddr );
         }
@@ -695,24 +817,509 @@ using socket_address_inet = socket_address<socket_address_family::inet, _Sockadd
 using socket_address_inet6 = socket_address<socket_address_family::inet6, _Sockaddr_inet6>;
 
 
-_NODISCARD inline std::shared_ptr<_Socket_address_base> _Create_socket_address( socket_address_family _Family, const sockaddr* _Sockaddr )
-    {   // construct socket_address structure based on the family
-    // Helper macro for socket_address structure creation
-#   define _CASE_ADDRESS_FAMILY(AF) \
-    case socket_address_family::AF: \
-        { \
-        return std::make_shared<socket_address_##AF>( reinterpret_cast<const _Sockaddr_##AF*>(_Sockaddr) ); \
+// STRUCT socket_address_storage
+struct socket_address_storage
+    {   // address of any family stored inline, trivially copyable
+public:
+    inline socket_address_storage() noexcept
+        : _MyStorage(), _MySize( 0 )
+        {   // construct empty socket address
         }
-    switch( _Family )
-        {
-        _CASE_ADDRESS_FAMILY( inet );
-        _CASE_ADDRESS_FAMILY( inet6 );
+
+    inline socket_address_storage( const sockaddr* _Sockaddr, size_t _Size ) noexcept
+        : socket_address_storage()
+        {   // construct socket address from native structure
+        _Assign( _Sockaddr, _Size );
+        }
+
+    template<socket_address_family _Family, typename _SockAddrTy>
+    inline socket_address_storage( const socket_address<_Family, _SockAddrTy>& _Addr ) noexcept
+        : socket_address_storage()
+        {   // construct copy of socket address of the specific family
+        _Assign( _Addr.get_native_sockaddr(), _Addr.get_native_sockaddr_size() );
+        }
+
+    _NODISCARD inline socket_address_family get_family() const noexcept
+        {   // get family of the stored address
+        return (this->_MySize >= sizeof( this->_MyStorage.ss_family ))
+            ? static_cast<socket_address_family>(this->_MyStorage.ss_family)
+            : socket_address_family::unspec;
+        }
+
+    _NODISCARD inline const sockaddr* get_native_sockaddr() const noexcept
+        {   // get native sockaddr structure
+        return reinterpret_cast<const sockaddr*>(&_MyStorage);
+        }
+
+    _NODISCARD inline size_t get_native_sockaddr_size() const noexcept
+        {   // get size of the stored address
+        return this->_MySize;
+        }
+
+    inline void _Assign( const sockaddr* _Sockaddr, size_t _Size ) noexcept
+        {   // copy native address, truncating it to the storage capacity
+        _Size = __impl::min( _Size, sizeof( this->_MyStorage ) );
+        if( _Sockaddr != nullptr && _Size != 0 )
+            __impl::memcpy( &this->_MyStorage, _Sockaddr, _Size );
+        _Set_size( _Size );
+        }
+
+    _NODISCARD inline sockaddr* _Data() noexcept
+        {   // get storage for the address written by the system
+        return reinterpret_cast<sockaddr*>(&this->_MyStorage);
+        }
+
+    inline void _Set_size( size_t _Size ) noexcept
+        {   // update size after the address has been written by the system
+        this->_MySize = __impl::min( _Size, sizeof( this->_MyStorage ) );
+        }
+
+protected:
+    sockaddr_storage _MyStorage;
+    size_t _MySize;
+    };
+
+static_assert( std::is_trivially_copyable<socket_address_storage>::value,
+    "socket_address_storage must be trivially copyable" );
+
+
+// STRUCT socket_buffer
+struct socket_buffer
+    {   // buffer descriptor passed to the system without conversion (iovec, WSABUF on Windows)
+#if defined( OS_WINDOWS )
+    ULONG size;
+    char* data;
+#else
+    void* data;
+    size_t size;
+#endif
+
+    inline socket_buffer() noexcept
+        {   // construct empty buffer descriptor
+        this->data = nullptr;
+        this->size = 0;
+        }
+
+    inline socket_buffer( void* _Data, size_t _Size ) noexcept
+        {   // construct buffer descriptor
+        this->data = reinterpret_cast<decltype(this->data)>(_Data);
+        this->size = static_cast<decltype(this->size)>(_Size);
+        }
+
+    inline socket_buffer( const void* _Data, size_t _Size ) noexcept
+        : socket_buffer( const_cast<void*>(_Data), _Size )
+        {   // construct descriptor of the data to send
+        }
+    };
+
+#if defined( OS_LINUX )
+static_assert( sizeof( socket_buffer ) == sizeof( iovec )
+    && offsetof( socket_buffer, data ) == offsetof( iovec, iov_base )
+    && offsetof( socket_buffer, size ) == offsetof( iovec, iov_len ),
+    "socket_buffer must be layout-compatible with iovec" );
+#endif
+
+
+// STRUCT socket_datagram
+struct socket_datagram
+    {   // entry of socket::recv_batch and socket::send_batch
+    void* data;                     // buffer of the datagram
+    size_t size;                    // capacity of the buffer, or number of bytes to send
+    size_t length;                  // number of bytes received or sent
+    socket_address_storage address; // source address, or destination (unspec for connected peer)
+    bool truncated;                 // received datagram did not fit into the buffer
+    };
+
+
+// STRUCT _Io_buffer_block
+class _Io_buffer_pool_state;
+struct _Io_buffer_shard;
+
+struct _Io_buffer_block
+    {   // header of the pooled buffer, the buffer itself follows the header
+    _Io_buffer_block* _Next;        // next free block of the shard
+    _Io_buffer_pool_state* _State;  // pool which owns the block
+    _Io_buffer_shard* _Shard;       // shard which carved the block
+    std::atomic<size_t> _Refs;      // number of io_buffer handles sharing the block
+    size_t _Size;                   // number of valid bytes in the buffer
+    };
+
+static constexpr size_t _Io_buffer_header_size = 64; // keeps buffers cache line aligned
+static_assert( sizeof( _Io_buffer_block ) <= _Io_buffer_header_size,
+    "_Io_buffer_block must fit into the buffer header" );
+
+
+// STRUCT _Io_buffer_shard
+struct alignas( 64 ) _Io_buffer_shard
+    {   // free blocks and slabs of the threads mapped to the shard
+    std::mutex _Mutex;
+    _Io_buffer_block* _Free = nullptr;
+    std::vector<void*> _Slabs;
+    };
+
+
+// CLASS _Io_buffer_pool_state
+class _Io_buffer_pool_state
+    {   // slabs of the io_buffer_pool, kept alive until the last buffer is released
+public:
+    _Io_buffer_pool_state( const _Io_buffer_pool_state& ) = delete;
+    _Io_buffer_pool_state& operator=( const _Io_buffer_pool_state& ) = delete;
+
+    static constexpr int _Huge_pages = 1;
+    static constexpr int _Numa_local = 2;
+    static constexpr size_t _Slab_blocks = 32;                   // minimal number of buffers carved at once
+    static constexpr size_t _Huge_page_size = 2 * 1024 * 1024;
+
+    inline _Io_buffer_pool_state( size_t _Buffer_size, int _Flags, int _Numa_node )
+        : _MyBuffer_size( _Buffer_size ), _MyFlags( _Flags ), _MyNode( _Numa_node ), _MyRefs( 1 )
+        {   // compute slab geometry and create per-thread shards
+        this->_MyBlock_size = _Io_buffer_header_size
+            + (_Buffer_size + _Io_buffer_header_size - 1) / _Io_buffer_header_size * _Io_buffer_header_size;
+#if defined( OS_LINUX )
+        const size_t _Granularity = ((_Flags & _Huge_pages) != 0)
+            ? _Huge_page_size
+            : static_cast<size_t>(::sysconf( _SC_PAGESIZE ));
+#else
+        const size_t _Granularity = _Io_buffer_header_size;
+#endif
+        this->_MySlab_size = (this->_MyBlock_size * _Slab_blocks + _Granularity - 1) / _Granularity * _Granularity;
+        this->_MyShard_count = __impl::max( static_cast<size_t>(std::thread::hardware_concurrency()), size_t( 1 ) );
+        // new does not honor the extended alignment before C++17, align the shards manually
+        // so that each of them takes separate cache lines
+        size_t _Space = this->_MyShard_count * sizeof( _Io_buffer_shard ) + alignof( _Io_buffer_shard );
+        this->_MyShard_storage = ::operator new( _Space );
+        void* _First = this->_MyShard_storage;
+        this->_MyShards = static_cast<_Io_buffer_shard*>(std::align( alignof( _Io_buffer_shard ),
+            this->_MyShard_count * sizeof( _Io_buffer_shard ), _First, _Space ));
+        for( size_t _Index = 0; _Index < this->_MyShard_count; ++_Index )
+            ::new (this->_MyShards + _Index) _Io_buffer_shard;
+        }
+
+    inline ~_Io_buffer_pool_state() noexcept
+        {   // release all slabs and shards
+        for( size_t _Index = 0; _Index < this->_MyShard_count; ++_Index )
+            {
+            for( void* _Slab : this->_MyShards[_Index]._Slabs )
+                {
+#if defined( OS_LINUX )
+                ::munmap( _Slab, this->_MySlab_size );
+#else
+                ::operator delete( _Slab );
+#endif
+                }
+            this->_MyShards[_Index].~_Io_buffer_shard();
+            }
+        ::operator delete( this->_MyShard_storage );
+        }
+
+    _NODISCARD inline _Io_buffer_block* _Allocate()
+        {   // take free block from the shard of the calling thread
+        _Io_buffer_shard& _Shard = _Get_shard();
+        _Io_buffer_block* _Block;
+            {
+            std::lock_guard<std::mutex> _Lock( _Shard._Mutex );
+            if( _Shard._Free == nullptr )
+                _Carve_slab( _Shard );
+            _Block = _Shard._Free;
+            _Shard._Free = _Block->_Next;
+            }
+        _Block->_Refs.store( 1, std::memory_order_relaxed );
+        _Block->_Size = 0;
+        this->_MyRefs.fetch_add( 1, std::memory_order_relaxed );
+        return _Block;
+        }
+
+    inline void _Deallocate( _Io_buffer_block* _Block ) noexcept
+        {   // return block to the shard which carved it, the slab stays on its NUMA node
+        _Io_buffer_shard& _Shard = *_Block->_Shard;
+            {
+            std::lock_guard<std::mutex> _Lock( _Shard._Mutex );
+            _Block->_Next = _Shard._Free;
+            _Shard._Free = _Block;
+            }
+        _Release();
+        }
+
+    inline void _Release() noexcept
+        {   // drop reference held by the pool or by the allocated buffer
+        if( this->_MyRefs.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+            delete this;
+        }
+
+    _NODISCARD inline size_t _Buffer_size() const noexcept
+        {   // get capacity of each buffer
+        return this->_MyBuffer_size;
+        }
+
+protected:
+    _NODISCARD inline _Io_buffer_shard& _Get_shard() const noexcept
+        {   // get shard assigned to the calling thread
+        static std::atomic<size_t> _Next_index( 0 );
+        thread_local const size_t _Index = _Next_index.fetch_add( 1, std::memory_order_relaxed );
+        return this->_MyShards[_Index % this->_MyShard_count];
+        }
+
+    inline void _Carve_slab( _Io_buffer_shard& _Shard )
+        {   // allocate new slab and split it into free blocks
+        _Shard._Slabs.reserve( _Shard._Slabs.size() + 1 );
+        char* const _Slab = static_cast<char*>(_Map_slab());
+        _Shard._Slabs.push_back( _Slab );
+        const size_t _Count = this->_MySlab_size / this->_MyBlock_size;
+        for( size_t _Index = _Count; _Index-- > 0; )
+            {
+            _Io_buffer_block* const _Block = ::new (_Slab + _Index * this->_MyBlock_size) _Io_buffer_block;
+            _Block->_Next = _Shard._Free;
+            _Block->_State = this;
+            _Block->_Shard = &_Shard;
+            _Shard._Free = _Block;
+            }
+        }
+
+#if defined( OS_LINUX )
+    _NODISCARD inline void* _Map_slab()
+        {   // map slab memory, preferably backed by huge pages and placed on the requested node
+        void* _Slab = MAP_FAILED;
+        if( (this->_MyFlags & _Huge_pages) != 0 )
+            _Slab = ::mmap( nullptr, this->_MySlab_size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+        if( _Slab == MAP_FAILED )
+            {
+            // Hugetlbfs pages must be reserved by the administrator, fall back to
+            // regular pages and ask for transparent huge pages instead.
+            _Slab = ::mmap( nullptr, this->_MySlab_size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+            if( _Slab == MAP_FAILED )
+                throw socket_exception( errno );
+#if defined( MADV_HUGEPAGE )
+            if( (this->_MyFlags & _Huge_pages) != 0 )
+                ::madvise( _Slab, this->_MySlab_size, MADV_HUGEPAGE );
+#endif
+            }
+        _Bind_slab( _Slab );
+        return _Slab;
+        }
+
+    inline void _Bind_slab( void* _Slab ) const noexcept
+        {   // prefer the NUMA node for the slab pages, called before the pages are touched
+        int _Node = this->_MyNode;
+        if( _Node < 0 && (this->_MyFlags & _Numa_local) != 0 )
+            {
+            unsigned _Cpu = 0;
+            unsigned _Current = 0;
+            if( ::syscall( SYS_getcpu, &_Cpu, &_Current, nullptr ) == 0 )
+                _Node = static_cast<int>(_Current);
+            }
+        constexpr size_t _Mask_bits = 8 * sizeof( unsigned long );
+        unsigned long _Mask[1024 / _Mask_bits] = {};
+        if( _Node < 0 || static_cast<size_t>(_Node) >= 1024 )
+            return;
+        _Mask[_Node / _Mask_bits] |= 1UL << (_Node % _Mask_bits);
+        // Placement is only a hint, the call fails on kernels without NUMA support.
+        (void)::syscall( SYS_mbind, _Slab, this->_MySlab_size, MPOL_PREFERRED,
+            _Mask, 1024 + 1, 0 );
+        }
+#else
+    _NODISCARD inline void* _Map_slab()
+        {   // allocate slab memory, huge pages and NUMA placement are not supported
+        return ::operator new( this->_MySlab_size );
+        }
+#endif
+
+    size_t _MyBuffer_size;
+    size_t _MyBlock_size;
+    size_t _MySlab_size;
+    int _MyFlags;
+    int _MyNode;
+    size_t _MyShard_count;
+    void* _MyShard_storage;
+    _Io_buffer_shard* _MyShards;
+    std::atomic<size_t> _MyRefs;
+    };
+
+
+// CLASS io_buffer
+class io_buffer
+    {   // reference-counted handle of the buffer allocated from io_buffer_pool
+    friend class io_buffer_pool;
+
+public:
+    inline io_buffer() noexcept
+        : _MyBlock( nullptr )
+        {   // construct empty handle
+        }
+
+    inline io_buffer( const io_buffer& _Other ) noexcept
+        : _MyBlock( _Other._MyBlock )
+        {   // share buffer with _Other
+        if( this->_MyBlock != nullptr )
+            this->_MyBlock->_Refs.fetch_add( 1, std::memory_order_relaxed );
+        }
+
+    inline io_buffer( io_buffer&& _Other ) noexcept
+        : _MyBlock( _Other._MyBlock )
+        {   // take buffer from _Other
+        _Other._MyBlock = nullptr;
+        }
+
+    inline io_buffer& operator=( const io_buffer& _Other ) noexcept
+        {   // share buffer with _Other
+        io_buffer( _Other ).swap( *this );
+        return (*this);
+        }
+
+    inline io_buffer& operator=( io_buffer&& _Other ) noexcept
+        {   // take buffer from _Other
+        io_buffer( __impl::move( _Other ) ).swap( *this );
+        return (*this);
+        }
+
+    inline ~io_buffer() noexcept
+        {   // release buffer, the last handle returns it to the pool
+        reset();
+        }
+
+    inline void reset() noexcept
+        {   // release buffer and make handle empty
+        if( this->_MyBlock != nullptr
+            && this->_MyBlock->_Refs.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+            this->_MyBlock->_State->_Deallocate( this->_MyBlock );
+        this->_MyBlock = nullptr;
+        }
+
+    inline void swap( io_buffer& _Other ) noexcept
+        {   // exchange buffers
+        __impl::swap( this->_MyBlock, _Other._MyBlock );
+        }
+
+    _NODISCARD inline char* data() const noexcept
+        {   // get buffer memory, shared by all handles of the buffer
+        return (this->_MyBlock != nullptr)
+            ? reinterpret_cast<char*>(this->_MyBlock) + _Io_buffer_header_size
+            : nullptr;
+        }
+
+    _NODISCARD inline size_t size() const noexcept
+        {   // get number of valid bytes
+        return (this->_MyBlock != nullptr) ? this->_MyBlock->_Size : 0;
+        }
+
+    _NODISCARD inline size_t capacity() const noexcept
+        {   // get size of the buffer memory
+        return (this->_MyBlock != nullptr) ? this->_MyBlock->_State->_Buffer_size() : 0;
+        }
+
+    inline void resize( size_t _Size )
+        {   // set number of valid bytes, cannot exceed capacity
+        if( _Size > capacity() )
+            throw std::invalid_argument( "_Size cannot exceed capacity of the buffer" );
+        if( this->_MyBlock != nullptr )
+            this->_MyBlock->_Size = _Size;
+        }
+
+    _NODISCARD inline bool empty() const noexcept
+        {   // check if there are no valid bytes
+        return size() == 0;
+        }
+
+    _NODISCARD inline size_t use_count() const noexcept
+        {   // get number of handles sharing the buffer
+        return (this->_MyBlock != nullptr) ? this->_MyBlock->_Refs.load( std::memory_order_relaxed ) : 0;
+        }
+
+    _NODISCARD inline explicit operator bool() const noexcept
+        {   // check if handle owns a buffer
+        return this->_MyBlock != nullptr;
+        }
+
+    _NODISCARD inline socket_buffer send_buffer() const noexcept
+        {   // get descriptor of the valid bytes, for send_vec
+        return socket_buffer( data(), size() );
+        }
+
+    _NODISCARD inline socket_buffer recv_buffer() const noexcept
+        {   // get descriptor of the whole buffer memory, for recv_vec
+        return socket_buffer( data(), capacity() );
+        }
+
+protected:
+    inline explicit io_buffer( _Io_buffer_block* _Block ) noexcept
+        : _MyBlock( _Block )
+        {   // take freshly allocated block
         }
-#   undef _CASE_ADDRESS_FAMILY
-    throw socket_exception( -1, "address family not supported" );
+
+    _Io_buffer_block* _MyBlock;
+    };
+
+inline void swap( io_buffer& _Left, io_buffer& _Right ) noexcept
+    {   // exchange buffers
+    _Left.swap( _Right );
     }
 
 
+// CLASS io_buffer_pool
+class io_buffer_pool
+    {   // allocator of fixed-size I/O buffers carved from per-thread slabs
+    // Each thread allocates from its own shard, so buffers of a thread come from the
+    // same slabs, placed on the thread's NUMA node with numa_local. Released buffers
+    // go back to the shard which allocated them, even if released by another thread.
+    // The memory is returned to the system once the pool and all of its buffers are
+    // destroyed.
+public:
+    static constexpr int huge_pages = _Io_buffer_pool_state::_Huge_pages; // back slabs with huge pages (Linux)
+    static constexpr int numa_local = _Io_buffer_pool_state::_Numa_local; // place slabs on the node of the allocating thread (Linux)
+
+    io_buffer_pool( const io_buffer_pool& ) = delete;
+    io_buffer_pool& operator=( const io_buffer_pool& ) = delete;
+
+    inline explicit io_buffer_pool( size_t _Buffer_size = 16 * 1024, int _Flags = 0, int _Numa_node = -1 )
+        : _MyState( nullptr )
+        {   // construct pool of _Buffer_size buffers, _Numa_node >= 0 binds all slabs to the node
+        _LIBSOCK_CHECK_ARG_NOT_EQ( _Buffer_size, 0 );
+        this->_MyState = new _Io_buffer_pool_state( _Buffer_size, _Flags, _Numa_node );
+        }
+
+    inline io_buffer_pool( io_buffer_pool&& _Other ) noexcept
+        : _MyState( _Other._MyState )
+        {   // take pool from _Other
+        _Other._MyState = nullptr;
+        }
+
+    inline io_buffer_pool& operator=( io_buffer_pool&& _Other ) noexcept
+        {   // exchange pools, the old one is released by _Other
+        __impl::swap( this->_MyState, _Other._MyState );
+        return (*this);
+        }
+
+    inline ~io_buffer_pool() noexcept
+        {   // release pool, slabs are kept until all buffers are released
+        if( this->_MyState != nullptr )
+            this->_MyState->_Release();
+        }
+
+    _NODISCARD inline io_buffer allocate()
+        {   // get empty buffer
+        _Throw_if_uninitialized();
+        return io_buffer( this->_MyState->_Allocate() );
+        }
+
+    _NODISCARD inline size_t buffer_size() const noexcept
+        {   // get capacity of the allocated buffers
+        return (this->_MyState != nullptr) ? this->_MyState->_Buffer_size() : 0;
+        }
+
+protected:
+    inline void _Throw_if_uninitialized() const
+        {   // throw an exception if the pool has been moved from
+        if( this->_MyState == nullptr )
+            {
+            throw std::runtime_error( "pool has been moved from" );
+            }
+        }
+
+    _Io_buffer_pool_state* _MyState;
+    };
+
+
 // ENUM CLASS socket_address_flags
 enum class socket_address_flags
     {
@@ -738,7 +1345,7 @@ public:
     socket_type socktype;
     socket_protocol protocol;
     std::string canonname;
-    std::shared_ptr<_Socket_address_base> addr;
+    socket_address_storage addr;
 
 public:
     inline socket_address_info()
@@ -747,7 +1354,7 @@ public:
         , socktype( socket_type::unknown )
         , protocol( unknown_socket_protocol() )
         , canonname( "" )
-        , addr( nullptr )
+        , addr()
         {   // construct uninitialized socket address info
         }
 
@@ -761,7 +1368,7 @@ public:
         , socktype( _Type )
         , protocol( _Protocol )
         , canonname( "" )
-        , addr( nullptr )
+        , addr()
         {   // construct socket address info hints structure
         }
 
@@ -776,7 +1383,7 @@ public:
         , socktype( _Type )
         , protocol( _Protocol )
         , canonname( _Canonname )
-        , addr( nullptr )
+        , addr()
         {   // construct socket address info hints structure
         }
 
@@ -786,46 +1393,31 @@ public:
         , socktype( static_cast<socket_type>(_Addrinfo.ai_socktype) )
         , protocol( static_cast<int>(_Addrinfo.ai_protocol) )
         , canonname( _Addrinfo.ai_canonname ? _Addrinfo.ai_canonname : "" )
-        , addr( nullptr )
+        , addr( _Addrinfo.ai_addr, static_cast<size_t>(_Addrinfo.ai_addrlen) )
         {   // construct socket address info from platform-dependent addrinfo struct
-        this->addr = _Create_socket_address( this->family, _Addrinfo.ai_addr );
         }
 
     _NODISCARD inline addrinfo get_addrinfo() const noexcept
         {   // cast socket_address_info into platform-dependent addrinfo structure
-        _MyCanonname = nullptr;
-        const size_t _canoname_len = canonname.length() + 1;
-        if( _canoname_len > 1 )
-            {
-            _MyCanonname = std::shared_ptr<char>(
-                new char[_canoname_len], _Array_delete<char> );
-            // copy name to the temporary buffer
-            __impl::memcpy(
-                _MyCanonname.get(),
-                canonname.c_str(),
-                _canoname_len );
-            }
-        // prepare platform-dependent addrinfo structure
+        // The canonical name is not copied, the structure is valid as long as this
+        // socket_address_info is alive and not modified.
         addrinfo _addrinfo;
         __impl::memset( &_addrinfo, 0, sizeof( _addrinfo ) );
         _addrinfo.ai_family = static_cast<int>(family);
         _addrinfo.ai_socktype = static_cast<int>(socktype);
         _addrinfo.ai_protocol = static_cast<int>(protocol);
         _addrinfo.ai_flags = static_cast<int>(flags);
-        _addrinfo.ai_canonname = _MyCanonname.get();
+        _addrinfo.ai_canonname = !canonname.empty() ? const_cast<char*>(canonname.c_str()) : nullptr;
         return _addrinfo;
         }
-
-private:
-    mutable std::shared_ptr<char> _MyCanonname;
     };
 
 
-_NODISCARD inline socket_address_info get_socket_address_info(
+_NODISCARD inline std::shared_ptr<addrinfo> _Get_addrinfo(
     const std::string& _Hostname,
     const std::string& _Svc_name,
     const socket_address_info& _Hints )
-    {   // get socket address info using provided hints
+    {   // resolve the name, returned list is released with the last reference
     addrinfo* _addrinfo;
     addrinfo _hints = _Hints.get_addrinfo();
     const char* _pNodeName = !_Hostname.empty() ? _Hostname.c_str() : nullptr;
@@ -835,8 +1427,29 @@ _NODISCARD inline socket_address_info get_socket_address_info(
         throw socket_exception( -1 );
         }
     // pass retrieved pointer to shared_ptr for automatic memory management
-    std::shared_ptr<addrinfo> _addrinfo_sp( _addrinfo, __impl::freeaddrinfo );
-    return socket_address_info( *_addrinfo_sp );
+    return std::shared_ptr<addrinfo>( _addrinfo, __impl::freeaddrinfo );
+    }
+
+
+_NODISCARD inline socket_address_info get_socket_address_info(
+    const std::string& _Hostname,
+    const std::string& _Svc_name,
+    const socket_address_info& _Hints )
+    {   // get socket address info using provided hints
+    return socket_address_info( *_Get_addrinfo( _Hostname, _Svc_name, _Hints ) );
+    }
+
+
+_NODISCARD inline std::vector<socket_address_info> get_socket_address_info_list(
+    const std::string& _Hostname,
+    const std::string& _Svc_name,
+    const socket_address_info& _Hints )
+    {   // get all socket addresses the name resolves to, in the order of preference
+    const std::shared_ptr<addrinfo> _addrinfo_sp = _Get_addrinfo( _Hostname, _Svc_name, _Hints );
+    std::vector<socket_address_info> _List;
+    for( const addrinfo* _Entry = _addrinfo_sp.get(); _Entry != nullptr; _Entry = _Entry->ai_next )
+        _List.push_back( socket_address_info( *_Entry ) );
+    return _List;
     }
 
 
@@ -1135,22 +1748,57 @@ protected:
     };
 
 
-// ENUM CLASS socket_recv_flags
-enum class socket_recv_flags
+// ENUM CLASS socket_mode
+enum class socket_mode
     {
-    none                = 0,
-    oob                 = MSG_OOB,
-    peek                = MSG_PEEK,
-    trunc               = MSG_TRUNC,
-    wait_all            = MSG_WAITALL
+    blocking            = 0,                // calls wait until the operation can be completed
+    nonblocking         = 1                 // calls fail with "would block" instead of waiting
     };
 
-using _Socket_recv_flags_helper = _Socket_flags_helper<socket_recv_flags, int>;
-
-_NODISCARD _Socket_recv_flags_helper operator|( socket_recv_flags _1, socket_recv_flags _2 ) noexcept
-    {   // construct socket recv flags helper from two flags
-    return _Socket_recv_flags_helper( _1 ) | _2;
-    }
+
+// STRUCT TEMPLATE socket_result
+template<typename _Ty>
+struct socket_result
+    {
+    _Ty value;                  // operation result, valid if the operation succeeded
+    std::error_code error;      // error reported by the operation
+    bool would_block;           // operation could not be completed without blocking
+
+    _NODISCARD inline explicit operator bool() const noexcept
+        {   // check if operation succeeded
+        return (!this->error) && (!this->would_block);
+        }
+    };
+
+template<>
+struct socket_result<void>
+    {
+    std::error_code error;      // error reported by the operation
+    bool would_block;           // operation is in progress or could not be started without blocking
+
+    _NODISCARD inline explicit operator bool() const noexcept
+        {   // check if operation succeeded
+        return (!this->error) && (!this->would_block);
+        }
+    };
+
+
+// ENUM CLASS socket_recv_flags
+enum class socket_recv_flags
+    {
+    none                = 0,
+    oob                 = MSG_OOB,
+    peek                = MSG_PEEK,
+    trunc               = MSG_TRUNC,
+    wait_all            = MSG_WAITALL
+    };
+
+using _Socket_recv_flags_helper = _Socket_flags_helper<socket_recv_flags, int>;
+
+_NODISCARD _Socket_recv_flags_helper operator|( socket_recv_flags _1, socket_recv_flags _2 ) noexcept
+    {   // construct socket recv flags helper from two flags
+    return _Socket_recv_flags_helper( _1 ) | _2;
+    }
 
 
 // ENUM CLASS socket_send_flags
@@ -1158,7 +1806,11 @@ enum class socket_send_flags
     {
     none                = 0,
     dont_route          = MSG_DONTROUTE,
-    oob                 = MSG_OOB
+    oob                 = MSG_OOB,
+#if defined( OS_LINUX )
+    zerocopy            = MSG_ZEROCOPY,     // send without copying, see zerocopy_sender
+    more                = MSG_MORE,         // more data follows, delay sending partial segment
+#endif
     };
 
 using _Socket_send_flags_helper = _Socket_flags_helper<socket_send_flags, int>;
@@ -1169,6 +1821,184 @@ _NODISCARD _Socket_send_flags_helper operator|( socket_send_flags _1, socket_sen
     }
 
 
+#if defined( OS_LINUX )
+// STRUCT _Splice_pipe
+struct _Splice_pipe
+    {   // kernel pipe moving data between descriptors with splice, empty between uses
+    static constexpr size_t _Capacity = 64 * 1024; // default pipe size
+
+    int _Read;
+    int _Write;
+
+    _Splice_pipe( const _Splice_pipe& ) = delete;
+    _Splice_pipe& operator=( const _Splice_pipe& ) = delete;
+
+    inline _Splice_pipe()
+        : _Read( -1 ), _Write( -1 )
+        {   // create pipe
+        _Open();
+        }
+
+    inline ~_Splice_pipe() noexcept
+        {   // close pipe
+        _Close();
+        }
+
+    inline void _Reset()
+        {   // discard data left in the pipe after a failed transfer
+        _Close();
+        _Open();
+        }
+
+    _NODISCARD static inline _Splice_pipe& _Get()
+        {   // get pipe of the calling thread
+        thread_local _Splice_pipe _Pipe;
+        return _Pipe;
+        }
+
+    inline void _Open()
+        {   // create non-blocking pipe
+        int _Fds[2];
+        _Throw_if_failed( ::pipe2( _Fds, O_CLOEXEC | O_NONBLOCK ) );
+        this->_Read = _Fds[0];
+        this->_Write = _Fds[1];
+        }
+
+    inline void _Close() noexcept
+        {   // close both ends of the pipe
+        if( this->_Read >= 0 )
+            ::close( this->_Read );
+        if( this->_Write >= 0 )
+            ::close( this->_Write );
+        this->_Read = -1;
+        this->_Write = -1;
+        }
+    };
+
+
+// STRUCT _Splice_transfer
+struct _Splice_transfer
+    {   // file data already spliced into the pipe, but not yet into the non-blocking socket
+    _Splice_pipe _Pipe;
+    size_t _Pending;
+
+    inline _Splice_transfer()
+        : _Pipe(), _Pending( 0 )
+        {   // create empty transfer
+        }
+    };
+
+
+// CLASS _Mirrored_memory
+class _Mirrored_memory
+    {   // memory mapped twice back to back, data wrapping around its end is contiguous
+public:
+    _Mirrored_memory( const _Mirrored_memory& ) = delete;
+    _Mirrored_memory& operator=( const _Mirrored_memory& ) = delete;
+
+    inline _Mirrored_memory() noexcept
+        : _MyData( nullptr ), _MySize( 0 )
+        {   // construct empty mapping
+        }
+
+    inline explicit _Mirrored_memory( size_t _Size )
+        : _MyData( nullptr ), _MySize( 0 )
+        {   // map _Size bytes twice, _Size must be multiple of the page size
+        const int _File = static_cast<int>(::syscall( SYS_memfd_create, "libsock_ring", MFD_CLOEXEC ));
+        _Throw_if_failed( _File );
+        if( ::ftruncate( _File, static_cast<off_t>(_Size) ) < 0 )
+            {
+            const int _Errval = errno;
+            ::close( _File );
+            throw socket_exception( _Errval );
+            }
+        // reserve address space for both mappings, then map the file over it
+        void* const _Base = ::mmap( nullptr, 2 * _Size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        if( _Base == MAP_FAILED )
+            {
+            const int _Errval = errno;
+            ::close( _File );
+            throw socket_exception( _Errval );
+            }
+        char* const _Data = static_cast<char*>(_Base);
+        if( ::mmap( _Data, _Size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, _File, 0 ) == MAP_FAILED
+            || ::mmap( _Data + _Size, _Size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, _File, 0 ) == MAP_FAILED )
+            {
+            const int _Errval = errno;
+            ::munmap( _Base, 2 * _Size );
+            ::close( _File );
+            throw socket_exception( _Errval );
+            }
+        ::close( _File );
+        this->_MyData = _Data;
+        this->_MySize = _Size;
+        }
+
+    inline _Mirrored_memory( _Mirrored_memory&& _Other ) noexcept
+        : _MyData( _Other._MyData ), _MySize( _Other._MySize )
+        {   // take mapping
+        _Other._MyData = nullptr;
+        _Other._MySize = 0;
+        }
+
+    inline _Mirrored_memory& operator=( _Mirrored_memory&& _Other ) noexcept
+        {   // exchange mappings, the old one is released by _Other
+        _Swap( _Other );
+        return (*this);
+        }
+
+    inline ~_Mirrored_memory() noexcept
+        {   // unmap both views
+        if( this->_MyData != nullptr )
+            ::munmap( this->_MyData, 2 * this->_MySize );
+        }
+
+    inline void _Swap( _Mirrored_memory& _Other ) noexcept
+        {   // exchange mappings
+        __impl::swap( this->_MyData, _Other._MyData );
+        __impl::swap( this->_MySize, _Other._MySize );
+        }
+
+    _NODISCARD inline char* _Data() const noexcept
+        {   // get first view, followed by the second one
+        return this->_MyData;
+        }
+
+    _NODISCARD inline size_t _Size() const noexcept
+        {   // get size of single view
+        return this->_MySize;
+        }
+
+    // largest size which can be rounded and mapped twice
+    static constexpr size_t _Max_size = (std::numeric_limits<size_t>::max() >> 2) + 1;
+
+    _NODISCARD static inline size_t _Round_size( size_t _Size ) noexcept
+        {   // round size up to the power of two which is multiple of the page size
+        // _Size must not be greater than _Max_size, otherwise the result overflows.
+        size_t _Rounded = static_cast<size_t>(::sysconf( _SC_PAGESIZE ));
+        while( _Rounded < _Size )
+            _Rounded <<= 1;
+        return _Rounded;
+        }
+
+protected:
+    char* _MyData;
+    size_t _MySize;
+    };
+#endif
+
+
+class socket_reactor;
+struct accepted_socket;
+
+#if defined( _LIBSOCK_HAS_COROUTINES )
+class _Socket_send_awaitable;
+class _Socket_recv_awaitable;
+class _Socket_accept_awaitable;
+class _Socket_connect_awaitable;
+#endif
+
+
 // CLASS socket
 class socket
     {
@@ -1187,23 +2017,48 @@ public:
         , _MyAddr_family( socket_address_family::unknown )
         , _MyType( socket_type::unknown )
         , _MyProtocol( unknown_socket_protocol() )
+        , _MyReactor( nullptr )
+        , _MyNonblocking( false )
         {   // construct uninitialized socket
         }
 
-    inline socket( socket_address_family _Family, socket_type _Type, socket_protocol _Protocol )
+    inline socket( socket_address_family _Family, socket_type _Type, socket_protocol _Protocol,
+            socket_mode _Mode = socket_mode::blocking )
         : _MyHandle( _Invalid_socket )
         , _MyAddr_family( _Family )
         , _MyType( _Type )
         , _MyProtocol( _Protocol )
+        , _MyReactor( nullptr )
+        , _MyNonblocking( false )
         {   // construct socket object
+        int _Native_type = static_cast<int>(_Type);
+#   if defined( OS_LINUX )
+        if( _Mode == socket_mode::nonblocking )
+            { // create non-blocking socket in a single call
+            _Native_type |= SOCK_NONBLOCK;
+            this->_MyNonblocking = true;
+            }
+#   endif
         this->_MyHandle = _Throw_if_failed( __impl::socket(
             static_cast<int>(_Family),
-            static_cast<int>(_Type),
+            _Native_type,
             static_cast<int>(_Protocol) ) );
+        if( _Mode == socket_mode::nonblocking && !this->_MyNonblocking )
+            {
+            try
+                {
+                set_nonblocking( true );
+                }
+            catch( ... )
+                {
+                _Close();
+                throw;
+                }
+            }
         }
 
-    inline socket( const socket_address_info& _Addrinfo )
-        : socket( _Addrinfo.family, _Addrinfo.socktype, _Addrinfo.protocol )
+    inline socket( const socket_address_info& _Addrinfo, socket_mode _Mode = socket_mode::blocking )
+        : socket( _Addrinfo.family, _Addrinfo.socktype, _Addrinfo.protocol, _Mode )
         {   // construct socket object from addrinfo structure
         this->_MyAddrinfo.reset( new socket_address_info( _Addrinfo ) );
         }
@@ -1232,6 +2087,12 @@ public:
         __impl::swap( _MyAddr_family, _Other._MyAddr_family );
         __impl::swap( _MyType, _Other._MyType );
         __impl::swap( _MyProtocol, _Other._MyProtocol );
+        __impl::swap( _MyAddrinfo, _Other._MyAddrinfo );
+        __impl::swap( _MyReactor, _Other._MyReactor );
+        __impl::swap( _MyNonblocking, _Other._MyNonblocking );
+#if defined( OS_LINUX )
+        __impl::swap( _MyFile_transfer, _Other._MyFile_transfer );
+#endif
         }
 
     template<typename _SockOptTy>
@@ -1277,11 +2138,20 @@ public:
         }
 
     inline virtual int send( const void* _Data, size_t _ByteSize, _Socket_send_flags_helper _Flags = socket_send_flags::none )
-        {   // send message to the remote host
+        {   // send message to the remote host, closed connection is reported by exception, not SIGPIPE
         return _Throw_if_failed( (int)__impl::send( this->_MyHandle,
             reinterpret_cast<const _Sockcomm_data_t*>(_Data),
             static_cast<_Sockcomm_data_size_t>(_ByteSize),
-            static_cast<int>(_Flags) ) );
+            static_cast<int>(_Flags) | socket::_Send_nosignal ) );
+        }
+
+    _NODISCARD inline socket_result<int> send( const void* _Data, size_t _ByteSize, std::nothrow_t,
+            _Socket_send_flags_helper _Flags = socket_send_flags::none ) noexcept
+        {   // send message to the remote host, report failures via result
+        return _Make_result<int>( (int)__impl::send( this->_MyHandle,
+            reinterpret_cast<const _Sockcomm_data_t*>(_Data),
+            static_cast<_Sockcomm_data_size_t>(_ByteSize),
+            static_cast<int>(_Flags) | socket::_Send_nosignal ) );
         }
 
     template<typename _SockAddrTy>
@@ -1291,11 +2161,36 @@ public:
         return _Throw_if_failed( (int)__impl::sendto( this->_MyHandle,
             reinterpret_cast<const _Sockcomm_data_t*>(_Data),
             static_cast<_Sockcomm_data_size_t>(_ByteSize),
-            static_cast<int>(_Flags),
+            static_cast<int>(_Flags) | socket::_Send_nosignal,
+            reinterpret_cast<const sockaddr*>(_Addr),
+            static_cast<_Sock_size_t>(_Addrlen) ) );
+        }
+
+    template<typename _SockAddrTy>
+    _NODISCARD inline socket_result<int> send_to( const void* _Data, size_t _ByteSize, const _SockAddrTy* _Addr, size_t _Addrlen,
+            std::nothrow_t, _Socket_send_flags_helper _Flags = socket_send_flags::none ) noexcept
+        {   // send message to the remote host, report failures via result
+        return _Make_result<int>( (int)__impl::sendto( this->_MyHandle,
+            reinterpret_cast<const _Sockcomm_data_t*>(_Data),
+            static_cast<_Sockcomm_data_size_t>(_ByteSize),
+            static_cast<int>(_Flags) | socket::_Send_nosignal,
             reinterpret_cast<const sockaddr*>(_Addr),
             static_cast<_Sock_size_t>(_Addrlen) ) );
         }
 
+    inline int send_to( const void* _Data, size_t _ByteSize, const socket_address_storage& _Addr,
+            _Socket_send_flags_helper _Flags = socket_send_flags::none )
+        {   // send message to the remote host
+        return send_to( _Data, _ByteSize, _Addr.get_native_sockaddr(), _Addr.get_native_sockaddr_size(), _Flags );
+        }
+
+    _NODISCARD inline socket_result<int> send_to( const void* _Data, size_t _ByteSize, const socket_address_storage& _Addr,
+            std::nothrow_t, _Socket_send_flags_helper _Flags = socket_send_flags::none ) noexcept
+        {   // send message to the remote host, report failures via result
+        return send_to( _Data, _ByteSize, _Addr.get_native_sockaddr(), _Addr.get_native_sockaddr_size(),
+            std::nothrow, _Flags );
+        }
+
     inline virtual int recv( void* _Data, size_t _ByteSize, _Socket_recv_flags_helper _Flags = socket_recv_flags::none )
         {   // receive message from the remote host
         return _Throw_if_failed( (int)__impl::recv( this->_MyHandle,
@@ -1304,6 +2199,15 @@ public:
             static_cast<int>(_Flags) ) );
         }
 
+    _NODISCARD inline socket_result<int> recv( void* _Data, size_t _ByteSize, std::nothrow_t,
+            _Socket_recv_flags_helper _Flags = socket_recv_flags::none ) noexcept
+        {   // receive message from the remote host, report failures via result
+        return _Make_result<int>( (int)__impl::recv( this->_MyHandle,
+            reinterpret_cast<_Sockcomm_data_t*>(_Data),
+            static_cast<_Sockcomm_data_size_t>(_ByteSize),
+            static_cast<int>(_Flags) ) );
+        }
+
     template<typename _SockAddrTy>
     inline int recv_from( void* _Data, size_t _ByteSize, _SockAddrTy* _Addr, size_t* _Addrlen,
             _Socket_recv_flags_helper _Flags = socket_recv_flags::none )
@@ -1324,6 +2228,392 @@ public:
         return receivedByteCount;
         }
 
+    template<typename _SockAddrTy>
+    _NODISCARD inline socket_result<int> recv_from( void* _Data, size_t _ByteSize, _SockAddrTy* _Addr, size_t* _Addrlen,
+            std::nothrow_t, _Socket_recv_flags_helper _Flags = socket_recv_flags::none ) noexcept
+        {   // receive message from the remote host, report failures via result
+        _Sock_size_t addrlen = _Static_optional_or_default<_Sock_size_t>( _Addrlen, 0 );
+        socket_result<int> _Result = _Make_result<int>( (int)__impl::recvfrom( this->_MyHandle,
+            reinterpret_cast<_Sockcomm_data_t*>(_Data),
+            static_cast<_Sockcomm_data_size_t>(_ByteSize),
+            static_cast<int>(_Flags),
+            reinterpret_cast<sockaddr*>(_Addr),
+            reinterpret_cast<_Sock_size_t*>((_Addrlen) ? &addrlen : nullptr) ) );
+        if( _Addrlen != nullptr && _Result )
+            { // Pass retrieved addrlen to the actual output parameter
+            (*_Addrlen) = static_cast<size_t>(addrlen);
+            }
+        return _Result;
+        }
+
+    inline int recv_from( void* _Data, size_t _ByteSize, socket_address_storage& _Addr,
+            _Socket_recv_flags_helper _Flags = socket_recv_flags::none )
+        {   // receive message from the remote host, store address of the sender
+        size_t _Addrlen = sizeof( sockaddr_storage );
+        const int _Retval = recv_from( _Data, _ByteSize, _Addr._Data(), &_Addrlen, _Flags );
+        _Addr._Set_size( _Addrlen );
+        return _Retval;
+        }
+
+    _NODISCARD inline socket_result<int> recv_from( void* _Data, size_t _ByteSize, socket_address_storage& _Addr,
+            std::nothrow_t, _Socket_recv_flags_helper _Flags = socket_recv_flags::none ) noexcept
+        {   // receive message from the remote host, report failures via result
+        size_t _Addrlen = sizeof( sockaddr_storage );
+        socket_result<int> _Result = recv_from( _Data, _ByteSize, _Addr._Data(), &_Addrlen, std::nothrow, _Flags );
+        if( _Result )
+            _Addr._Set_size( _Addrlen );
+        return _Result;
+        }
+
+    inline int send_vec( const socket_buffer* _Buffers, size_t _Count,
+            _Socket_send_flags_helper _Flags = socket_send_flags::none )
+        {   // send data gathered from multiple buffers in a single call
+        return _Throw_if_failed( _Send_vec( _Buffers, _Count, static_cast<int>(_Flags) | socket::_Send_nosignal ) );
+        }
+
+    inline int send_vec( std::initializer_list<socket_buffer> _Buffers,
+            _Socket_send_flags_helper _Flags = socket_send_flags::none )
+        {   // send data gathered from multiple buffers in a single call
+        return send_vec( _Buffers.begin(), _Buffers.size(), _Flags );
+        }
+
+    _NODISCARD inline socket_result<int> send_vec( const socket_buffer* _Buffers, size_t _Count, std::nothrow_t,
+            _Socket_send_flags_helper _Flags = socket_send_flags::none ) noexcept
+        {   // send data gathered from multiple buffers, report failures via result
+        return _Make_result<int>( _Send_vec( _Buffers, _Count, static_cast<int>(_Flags) | socket::_Send_nosignal ) );
+        }
+
+    inline int recv_vec( socket_buffer* _Buffers, size_t _Count,
+            _Socket_recv_flags_helper _Flags = socket_recv_flags::none )
+        {   // receive data scattered into multiple buffers in a single call
+        return _Throw_if_failed( _Recv_vec( _Buffers, _Count, static_cast<int>(_Flags) ) );
+        }
+
+    _NODISCARD inline socket_result<int> recv_vec( socket_buffer* _Buffers, size_t _Count, std::nothrow_t,
+            _Socket_recv_flags_helper _Flags = socket_recv_flags::none ) noexcept
+        {   // receive data scattered into multiple buffers, report failures via result
+        return _Make_result<int>( _Recv_vec( _Buffers, _Count, static_cast<int>(_Flags) ) );
+        }
+
+    inline int send( const io_buffer& _Buffer, _Socket_send_flags_helper _Flags = socket_send_flags::none )
+        {   // send valid bytes of the pooled buffer
+        return send( _Buffer.data(), _Buffer.size(), _Flags );
+        }
+
+    _NODISCARD inline socket_result<int> send( const io_buffer& _Buffer, std::nothrow_t,
+            _Socket_send_flags_helper _Flags = socket_send_flags::none ) noexcept
+        {   // send valid bytes of the pooled buffer, report failures via result
+        return send( _Buffer.data(), _Buffer.size(), std::nothrow, _Flags );
+        }
+
+    inline int recv( io_buffer& _Buffer, _Socket_recv_flags_helper _Flags = socket_recv_flags::none )
+        {   // receive into the pooled buffer, its size is set to the number of received bytes
+        const int _Retval = recv( _Buffer.data(), _Buffer.capacity(), _Flags );
+        _Buffer.resize( __impl::min( static_cast<size_t>(_Retval), _Buffer.capacity() ) );
+        return _Retval;
+        }
+
+    _NODISCARD inline socket_result<int> recv( io_buffer& _Buffer, std::nothrow_t,
+            _Socket_recv_flags_helper _Flags = socket_recv_flags::none ) noexcept
+        {   // receive into the pooled buffer, report failures via result
+        socket_result<int> _Result = recv( _Buffer.data(), _Buffer.capacity(), std::nothrow, _Flags );
+        if( _Result )
+            _Buffer.resize( __impl::min( static_cast<size_t>(_Result.value), _Buffer.capacity() ) );
+        return _Result;
+        }
+
+#if defined( OS_LINUX )
+    inline size_t recv_batch( socket_datagram* _Datagrams, size_t _Count,
+            std::chrono::milliseconds _Timeout = std::chrono::milliseconds( 0 ),
+            _Socket_recv_flags_helper _Flags = socket_recv_flags::none )
+        {   // receive up to _Count datagrams, returns number of received datagrams
+        // Without _Timeout the call waits only for the first datagram (unless the socket
+        // is non-blocking) and returns it together with the ones already queued. With
+        // _Timeout it waits until the whole batch is received or the timeout expires.
+        _LIBSOCK_CHECK_ARG_NOT_NULL( _Datagrams );
+        const std::chrono::steady_clock::time_point _Deadline = std::chrono::steady_clock::now() + _Timeout;
+        size_t _Received = 0;
+        while( _Received < _Count )
+            {
+            const size_t _Chunk = __impl::min( _Count - _Received, static_cast<size_t>(socket::_Batch_size) );
+            int _Call_flags = static_cast<int>(_Flags);
+            if( _Received != 0 || _Timeout.count() > 0 )
+                _Call_flags |= MSG_DONTWAIT;
+            const int _Retval = _Recv_batch( _Datagrams + _Received, _Chunk, _Call_flags );
+            if( _Retval < 0 )
+                {
+                const int _Errval = __impl::geterror( _Retval );
+                if( _Errval == EINTR && _Received == 0 )
+                    continue;
+                if( !_Is_would_block( _Errval ) && _Errval != EINTR )
+                    {
+                    if( _Received == 0 )
+                        throw socket_exception( _Errval );
+                    break; // report the error on the next call
+                    }
+                }
+            else
+                {
+                _Received += static_cast<size_t>(_Retval);
+                if( static_cast<size_t>(_Retval) == _Chunk )
+                    continue; // more datagrams may be queued
+                }
+            if( _Timeout.count() <= 0 )
+                break;
+            const std::chrono::milliseconds::rep _Remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                _Deadline - std::chrono::steady_clock::now() ).count();
+            if( _Remaining <= 0 )
+                break;
+            pollfd _Pollfd{};
+            _Pollfd.fd = this->_MyHandle;
+            _Pollfd.events = POLLIN;
+            const int _Ready = __impl::poll( &_Pollfd, 1, static_cast<int>(_Remaining) );
+            if( _Ready < 0 && __impl::geterror( _Ready ) == EINTR )
+                continue;
+            if( _Ready <= 0 )
+                break;
+            }
+        return _Received;
+        }
+
+    inline size_t send_batch( socket_datagram* _Datagrams, size_t _Count,
+            _Socket_send_flags_helper _Flags = socket_send_flags::none )
+        {   // send _Count datagrams, returns number of sent datagrams
+        // Stops early only if the socket is non-blocking and its send buffer is full,
+        // or if an error occurs after some datagrams have already been sent.
+        _LIBSOCK_CHECK_ARG_NOT_NULL( _Datagrams );
+        size_t _Sent = 0;
+        while( _Sent < _Count )
+            {
+            const size_t _Chunk = __impl::min( _Count - _Sent, static_cast<size_t>(socket::_Batch_size) );
+            const int _Retval = _Send_batch( _Datagrams + _Sent, _Chunk, static_cast<int>(_Flags) );
+            if( _Retval < 0 )
+                {
+                const int _Errval = __impl::geterror( _Retval );
+                if( _Errval == EINTR )
+                    continue;
+                if( !_Is_would_block( _Errval ) && _Sent == 0 )
+                    throw socket_exception( _Errval );
+                break;
+                }
+            _Sent += static_cast<size_t>(_Retval);
+            }
+        return _Sent;
+        }
+
+    inline size_t recv_batch( io_buffer* _Buffers, size_t _Count,
+            std::chrono::milliseconds _Timeout = std::chrono::milliseconds( 0 ),
+            _Socket_recv_flags_helper _Flags = socket_recv_flags::none )
+        {   // receive datagrams from the connected peer into pooled buffers, sizes of the buffers are updated
+        _LIBSOCK_CHECK_ARG_NOT_NULL( _Buffers );
+        std::vector<socket_datagram>& _Datagrams = _Get_batch_datagrams( _Count );
+        for( size_t _Index = 0; _Index < _Count; ++_Index )
+            {
+            _Datagrams[_Index].data = _Buffers[_Index].data();
+            _Datagrams[_Index].size = _Buffers[_Index].capacity();
+            }
+        const size_t _Received = recv_batch( _Datagrams.data(), _Count, _Timeout, _Flags );
+        for( size_t _Index = 0; _Index < _Received; ++_Index )
+            _Buffers[_Index].resize( __impl::min( _Datagrams[_Index].length, _Buffers[_Index].capacity() ) );
+        return _Received;
+        }
+
+    inline size_t send_batch( const io_buffer* _Buffers, size_t _Count,
+            _Socket_send_flags_helper _Flags = socket_send_flags::none )
+        {   // send pooled buffers as datagrams to the connected peer, returns number of sent datagrams
+        _LIBSOCK_CHECK_ARG_NOT_NULL( _Buffers );
+        std::vector<socket_datagram>& _Datagrams = _Get_batch_datagrams( _Count );
+        for( size_t _Index = 0; _Index < _Count; ++_Index )
+            {
+            _Datagrams[_Index].data = _Buffers[_Index].data();
+            _Datagrams[_Index].size = _Buffers[_Index].size();
+            _Datagrams[_Index].address = socket_address_storage();
+            }
+        return send_batch( _Datagrams.data(), _Count, _Flags );
+        }
+#endif
+
+#if defined( OS_LINUX )
+    inline int send_segmented( const void* _Data, size_t _ByteSize, size_t _Segment_size,
+            _Socket_send_flags_helper _Flags = socket_send_flags::none )
+        {   // send buffer to the connected peer as datagrams of _Segment_size bytes (UDP GSO)
+        _LIBSOCK_CHECK_ARG_NOT_EQ( _Segment_size, 0 );
+        _LIBSOCK_CHECK_ARG_NOT_GREATER( _Segment_size, UINT16_MAX );
+        return _Throw_if_failed( _Send_segmented( _Data, _ByteSize, _Segment_size,
+            nullptr, 0, static_cast<int>(_Flags) ) );
+        }
+
+    template<typename _SockAddrTy>
+    inline int send_segmented_to( const void* _Data, size_t _ByteSize, size_t _Segment_size,
+            const _SockAddrTy* _Addr, size_t _Addrlen, _Socket_send_flags_helper _Flags = socket_send_flags::none )
+        {   // send buffer as datagrams of _Segment_size bytes (UDP GSO)
+        // Buffer is split by the kernel or the network card, only the last datagram may
+        // be shorter. Single call is limited to 64 segments and 64 KiB of data.
+        _LIBSOCK_CHECK_ARG_NOT_EQ( _Segment_size, 0 );
+        _LIBSOCK_CHECK_ARG_NOT_GREATER( _Segment_size, UINT16_MAX );
+        return _Throw_if_failed( _Send_segmented( _Data, _ByteSize, _Segment_size,
+            reinterpret_cast<const sockaddr*>(_Addr), _Addrlen, static_cast<int>(_Flags) ) );
+        }
+
+    inline int send_segmented_to( const void* _Data, size_t _ByteSize, size_t _Segment_size,
+            const socket_address_storage& _Addr, _Socket_send_flags_helper _Flags = socket_send_flags::none )
+        {   // send buffer as datagrams of _Segment_size bytes (UDP GSO)
+        return send_segmented_to( _Data, _ByteSize, _Segment_size,
+            _Addr.get_native_sockaddr(), _Addr.get_native_sockaddr_size(), _Flags );
+        }
+
+    inline int recv_segmented( void* _Data, size_t _ByteSize, size_t* _Segment_size,
+            _Socket_recv_flags_helper _Flags = socket_recv_flags::none )
+        {   // receive datagrams coalesced by GRO (socket_opt_udp::gro), reports size of the segments
+        return recv_segmented_from<sockaddr>( _Data, _ByteSize, _Segment_size, nullptr, nullptr, _Flags );
+        }
+
+    template<typename _SockAddrTy>
+    inline int recv_segmented_from( void* _Data, size_t _ByteSize, size_t* _Segment_size,
+            _SockAddrTy* _Addr, size_t* _Addrlen, _Socket_recv_flags_helper _Flags = socket_recv_flags::none )
+        {   // receive datagrams coalesced by GRO (socket_opt_udp::gro), reports size of the segments
+        // Received buffer holds consecutive datagrams of *_Segment_size bytes from the
+        // same source, only the last one may be shorter. Without coalescing the segment
+        // size is equal to the received length.
+        return _Throw_if_failed( _Recv_segmented( _Data, _ByteSize, _Segment_size,
+            reinterpret_cast<sockaddr*>(_Addr), _Addrlen, static_cast<int>(_Flags) ) );
+        }
+#endif
+
+#if defined( OS_LINUX )
+    inline size_t send_file( int _File, off_t _Offset, size_t _Length = std::numeric_limits<size_t>::max() )
+        {   // send file contents without copying them through user memory
+        const socket_result<size_t> _Result = send_file( _File, _Offset, _Length, std::nothrow );
+        if( _Result.error )
+            throw socket_exception( _Result.error.value() );
+        if( _Result.would_block )
+            throw socket_exception( EWOULDBLOCK );
+        return _Result.value;
+        }
+
+    _NODISCARD inline socket_result<size_t> send_file( int _File, off_t _Offset, size_t _Length,
+            std::nothrow_t ) noexcept
+        {   // send file contents, report failures via result
+        // Sends until _Length bytes or end of the file is reached, value 0 means the end of
+        // the file. Non-blocking socket stops as soon as it would block, returned count
+        // tells where to resume. Files not supported by sendfile are spliced through a
+        // pipe, data consumed from the file but not taken by the non-blocking socket is
+        // counted as sent and sent first by the next send_file call.
+        socket_result<size_t> _Result{};
+        int _Errval = _Flush_file_transfer();
+        size_t _Sent = 0;
+        while( _Errval == 0 && _Sent < _Length )
+            {
+            off_t _Position = _Offset + static_cast<off_t>(_Sent);
+            const ssize_t _Retval = ::sendfile( this->_MyHandle, _File, &_Position,
+                __impl::min<size_t>( _Length - _Sent, 0x7ffff000 ) );
+            if( _Retval > 0 )
+                {
+                _Sent += static_cast<size_t>(_Retval);
+                continue;
+                }
+            if( _Retval == 0 )
+                break; // end of file
+            _Errval = errno;
+            if( _Errval == EINVAL || _Errval == ENOSYS )
+                {
+                _Errval = _Splice_file( _File, _Position, _Length - _Sent, _Sent );
+                break;
+                }
+            if( _Errval == EINTR )
+                _Errval = 0;
+            }
+        if( _Errval != 0 && _Sent == 0 )
+            { // errors after a partial transfer are reported by the next call
+            if( _Is_would_block( _Errval ) )
+                _Result.would_block = true;
+            else
+                _Result.error = std::error_code( _Errval, socket_category() );
+            }
+        _Result.value = _Sent;
+        return _Result;
+        }
+
+    inline size_t send_file( const std::string& _Path, off_t _Offset = 0,
+            size_t _Length = std::numeric_limits<size_t>::max() )
+        {   // send contents of the file without copying them through user memory
+        const int _File = _Throw_if_failed( ::open( _Path.c_str(), O_RDONLY | O_CLOEXEC ) );
+        try
+            {
+            const size_t _Sent = send_file( _File, _Offset, _Length );
+            ::close( _File );
+            return _Sent;
+            }
+        catch( ... )
+            {
+            ::close( _File );
+            throw;
+            }
+        }
+
+    inline size_t recv_to_file( int _File, off_t _Offset, size_t _Max_bytes )
+        {   // move received data into the file without copying it through user memory
+        const socket_result<size_t> _Result = recv_to_file( _File, _Offset, _Max_bytes, std::nothrow );
+        if( _Result.error )
+            throw socket_exception( _Result.error.value() );
+        if( _Result.would_block )
+            throw socket_exception( EWOULDBLOCK );
+        return _Result.value;
+        }
+
+    _NODISCARD inline socket_result<size_t> recv_to_file( int _File, off_t _Offset, size_t _Max_bytes,
+            std::nothrow_t ) noexcept
+        {   // move received data into the file, report failures via result
+        // Like recv, single call waits (unless the socket is non-blocking) only until some
+        // data is available and moves at most 64 KiB, so that progress can be reported
+        // and the call can be driven by an event loop. Value 0 means that the connection
+        // has been closed. Offset -1 writes at the current position of the file.
+        socket_result<size_t> _Result{};
+        _Splice_pipe* _Pipe;
+        try
+            {
+            _Pipe = &_Splice_pipe::_Get();
+            }
+        catch( const socket_exception& _Exception )
+            {
+            _Result.error = _Exception.code();
+            return _Result;
+            }
+        ssize_t _Filled;
+        do
+            {
+            _Filled = ::splice( this->_MyHandle, nullptr, _Pipe->_Write, nullptr,
+                __impl::min( _Max_bytes, static_cast<size_t>(_Splice_pipe::_Capacity) ), SPLICE_F_MOVE );
+            }
+        while( _Filled < 0 && errno == EINTR );
+        if( _Filled <= 0 )
+            {
+            _Result = _Make_result<size_t>( static_cast<int>(_Filled) );
+            return _Result;
+            }
+        loff_t _Position = static_cast<loff_t>(_Offset);
+        size_t _Left = static_cast<size_t>(_Filled);
+        while( _Left > 0 )
+            { // write everything, the pipe is shared by all transfers of the thread
+            const ssize_t _Retval = ::splice( _Pipe->_Read, nullptr, _File,
+                (_Offset >= 0) ? &_Position : nullptr, _Left, SPLICE_F_MOVE );
+            if( _Retval > 0 )
+                {
+                _Left -= static_cast<size_t>(_Retval);
+                continue;
+                }
+            if( _Retval < 0 && errno == EINTR )
+                continue;
+            _Result.error = std::error_code( (_Retval < 0) ? errno : ENOSPC, socket_category() );
+            try { _Pipe->_Reset(); }
+            catch( ... ) {}
+            return _Result;
+            }
+        _Result.value = static_cast<size_t>(_Filled);
+        return _Result;
+        }
+#endif
+
     template<typename _SockAddrTy>
     inline void bind( const _SockAddrTy* _Addr, size_t _Addrlen )
         {   // bind socket to the network interface
@@ -1332,7 +2622,7 @@ public:
             static_cast<_Sock_size_t>(_Addrlen) ) );
         }
 
-    inline void bind( const _Socket_address_base& _Addr )
+    inline void bind( const socket_address_storage& _Addr )
         {   // bind socket to the network interface
         return bind( _Addr.get_native_sockaddr(),
             _Addr.get_native_sockaddr_size() );
@@ -1346,8 +2636,7 @@ public:
                 "Argumentless binding is available only if socket has been constructed "
                 "with socket_address_info structure" );
             }
-        return bind( _MyAddrinfo->addr->get_native_sockaddr(),
-            _MyAddrinfo->addr->get_native_sockaddr_size() );
+        return bind( _MyAddrinfo->addr );
         }
 
     inline void listen( size_t _QueueLength = SOMAXCONN )
@@ -1364,12 +2653,28 @@ public:
             static_cast<_Sock_size_t>(_Addrlen) ) );
         }
 
-    inline void connect( const _Socket_address_base& _Addr )
+    inline void connect( const socket_address_storage& _Addr )
         {   // connect to the remote host
         return connect( _Addr.get_native_sockaddr(),
             _Addr.get_native_sockaddr_size() );
         }
 
+    template<typename _SockAddrTy>
+    _NODISCARD inline socket_result<void> connect( const _SockAddrTy* _Addr, size_t _Addrlen, std::nothrow_t ) noexcept
+        {   // connect to the remote host, report failures via result
+        // Non-blocking sockets report connection in progress as "would block", completion
+        // is signaled by writability of the socket.
+        return _Make_result<void>( __impl::connect( this->_MyHandle,
+            reinterpret_cast<const sockaddr*>(_Addr),
+            static_cast<_Sock_size_t>(_Addrlen) ) );
+        }
+
+    _NODISCARD inline socket_result<void> connect( const socket_address_storage& _Addr, std::nothrow_t ) noexcept
+        {   // connect to the remote host, report failures via result
+        return connect( _Addr.get_native_sockaddr(),
+            _Addr.get_native_sockaddr_size(), std::nothrow );
+        }
+
     _NODISCARD inline socket accept()
         {   // accept incoming connection from the client
         return accept<sockaddr>( nullptr, nullptr );
@@ -1381,30 +2686,91 @@ public:
         // Length of _Addrlen value may differ, change it to platform-dependent
         // for the call and then cast it to size_t.
         _Sock_size_t addrlen = _Static_optional_or_default<_Sock_size_t>( _Addrlen, 0 );
-        _Socket_handle _Accepted_handle = _Throw_if_failed( __impl::accept( this->_MyHandle,
+        _Socket_handle _Accepted_handle = _Accept_native(
             reinterpret_cast<sockaddr*>(_Addr),
-            reinterpret_cast<_Sock_size_t*>((_Addrlen) ? &addrlen : nullptr) ) );
+            reinterpret_cast<_Sock_size_t*>((_Addrlen) ? &addrlen : nullptr) );
+        if( _Accepted_handle == _Invalid_socket )
+            throw socket_exception( __impl::geterror( -1 ) );
         if( _Addrlen != nullptr )
             { // Pass retrieved addrlen to the actual output parameter
             (*_Addrlen) = static_cast<size_t>(addrlen);
             }
-        return socket( static_cast<_Socket_handle>(_Accepted_handle),
-            this->_MyAddr_family, this->_MyType, this->_MyProtocol );
+        return _Make_accepted( _Accepted_handle );
         }
 
-    inline void shutdown( int _Flags = socket::_inout )
-        {   // close socket connection in specified direction
-        int how = 0;
-        if( (_Flags & socket::_inout) == socket::_inout )
-            how = socket::_Shut_inout;
-        else if( (_Flags & socket::in) == socket::in )
-            how = socket::_Shut_in;
-        else if( (_Flags & socket::out) == socket::out )
-            how = socket::_Shut_out;
-        _Throw_if_failed( __impl::shutdown( this->_MyHandle, how ) );
+    _NODISCARD inline socket_result<socket> accept( std::nothrow_t ) noexcept
+        {   // accept incoming connection from the client, report failures via result
+        return accept<sockaddr>( nullptr, nullptr, std::nothrow );
         }
 
-public:
+    template<typename _SockAddrTy>
+    _NODISCARD inline socket_result<socket> accept( _SockAddrTy* _Addr, size_t* _Addrlen, std::nothrow_t ) noexcept
+        {   // accept incoming connection from the client, report failures via result
+        _Sock_size_t addrlen = _Static_optional_or_default<_Sock_size_t>( _Addrlen, 0 );
+        _Socket_handle _Accepted_handle = _Accept_native(
+            reinterpret_cast<sockaddr*>(_Addr),
+            reinterpret_cast<_Sock_size_t*>((_Addrlen) ? &addrlen : nullptr) );
+        socket_result<socket> _Result{};
+        if( _Accepted_handle == _Invalid_socket )
+            {
+            _Result.error = _Make_result<void>( -1 ).error;
+            _Result.would_block = !_Result.error;
+            return _Result;
+            }
+        if( _Addrlen != nullptr )
+            { // Pass retrieved addrlen to the actual output parameter
+            (*_Addrlen) = static_cast<size_t>(addrlen);
+            }
+        _Result.value = _Make_accepted( _Accepted_handle );
+        return _Result;
+        }
+
+    _NODISCARD inline std::vector<accepted_socket> accept_batch( size_t _Max_count );
+
+    inline void shutdown( int _Flags = socket::_inout )
+        {   // close socket connection in specified direction
+        int how = 0;
+        if( (_Flags & socket::_inout) == socket::_inout )
+            how = socket::_Shut_inout;
+        else if( (_Flags & socket::in) == socket::in )
+            how = socket::_Shut_in;
+        else if( (_Flags & socket::out) == socket::out )
+            how = socket::_Shut_out;
+        _Throw_if_failed( __impl::shutdown( this->_MyHandle, how ) );
+        }
+
+    inline void set_nonblocking( bool _Nonblocking = true )
+        {   // switch socket between blocking and non-blocking mode
+#   if defined( OS_WINDOWS )
+        u_long _Mode = _Nonblocking ? 1 : 0;
+        _Throw_if_failed( ::ioctlsocket( this->_MyHandle, FIONBIO, &_Mode ) );
+#   elif defined( OS_LINUX )
+        const int _Flags = _Throw_if_failed( ::fcntl( this->_MyHandle, F_GETFL, 0 ) );
+        _Throw_if_failed( ::fcntl( this->_MyHandle, F_SETFL,
+            _Nonblocking ? (_Flags | O_NONBLOCK) : (_Flags & ~O_NONBLOCK) ) );
+#   else
+#   error set_nonblocking not implemented for this OS
+#   endif
+        this->_MyNonblocking = _Nonblocking;
+        }
+
+    _NODISCARD inline bool is_nonblocking() const noexcept
+        {   // check if socket is in non-blocking mode
+        return this->_MyNonblocking;
+        }
+
+#if defined( _LIBSOCK_HAS_COROUTINES )
+    // Awaitable operations suspend the calling coroutine until the socket is ready.
+    // The socket must be attached to a reactor (see socket_reactor::attach).
+    _NODISCARD inline _Socket_send_awaitable async_send( const void* _Data, size_t _ByteSize,
+        _Socket_send_flags_helper _Flags = socket_send_flags::none );
+    _NODISCARD inline _Socket_recv_awaitable async_recv( void* _Data, size_t _ByteSize,
+        _Socket_recv_flags_helper _Flags = socket_recv_flags::none );
+    _NODISCARD inline _Socket_accept_awaitable async_accept();
+    _NODISCARD inline _Socket_connect_awaitable async_connect( const socket_address_storage& _Addr );
+#endif
+
+public:
     _NODISCARD inline _Socket_handle get_native_handle() const noexcept
         {   // retrieve native socket handle
         return this->_MyHandle;
@@ -1425,6 +2791,11 @@ public:
         return this->_MyProtocol;
         }
 
+    _NODISCARD inline socket_reactor* get_reactor() const noexcept
+        {   // get reactor the socket is attached to
+        return this->_MyReactor;
+        }
+
 protected:
     _Socket_handle _MyHandle;
     socket_address_family _MyAddr_family;
@@ -1432,22 +2803,34 @@ protected:
     socket_protocol _MyProtocol;
 
     std::shared_ptr<socket_address_info> _MyAddrinfo;
+    socket_reactor* _MyReactor;
+    bool _MyNonblocking;
+#if defined( OS_LINUX )
+    std::unique_ptr<_Splice_transfer> _MyFile_transfer; // send_file data not taken by the socket yet
+#endif
 
     inline socket( _Socket_handle _Handle, socket_address_family _Family, socket_type _Type, socket_protocol _Protocol ) noexcept
         : _MyHandle( _Handle )
         , _MyAddr_family( _Family )
         , _MyType( _Type )
         , _MyProtocol( _Protocol )
+        , _MyReactor( nullptr )
+        , _MyNonblocking( false )
         {   // construct socket object from existing handle
         }
 
     inline void _Close() noexcept
         {   // close the socket handle
+        _Detach_reactor();
         __impl::closesocket( this->_MyHandle );
         this->_MyHandle = _Invalid_socket;
         this->_MyAddr_family = socket_address_family::unknown;
         this->_MyType = socket_type::unknown;
         this->_MyProtocol = unknown_socket_protocol();
+        this->_MyNonblocking = false;
+#if defined( OS_LINUX )
+        this->_MyFile_transfer.reset();
+#endif
         }
 
     _NODISCARD inline bool _Is_stream_socket() const noexcept
@@ -1456,6 +2839,306 @@ protected:
             || (this->_MyType == socket_type::seqpacket);
         }
 
+    inline void _Detach_reactor() noexcept;
+
+    _NODISCARD static inline bool _Is_would_block( int _Errval ) noexcept
+        {   // check if error reports operation which cannot be completed immediately
+#   if defined( OS_WINDOWS )
+        return (_Errval == WSAEWOULDBLOCK) || (_Errval == WSAEINPROGRESS);
+#   else
+        return (_Errval == EAGAIN) || (_Errval == EWOULDBLOCK) || (_Errval == EINPROGRESS);
+#   endif
+        }
+
+    template<typename _Ty>
+    _NODISCARD static inline socket_result<_Ty> _Make_result( int _Retval ) noexcept
+        {   // construct operation result from native return value
+        socket_result<_Ty> _Result{};
+        if( _Retval < 0 )
+            { // "would block" is reported separately from the errors
+            const int _Errval = __impl::geterror( _Retval );
+            if( _Is_would_block( _Errval ) )
+                _Result.would_block = true;
+            else
+                _Result.error = std::error_code( _Errval, socket_category() );
+            }
+        else _Set_result_value( _Result, _Retval );
+        return _Result;
+        }
+
+    template<typename _Ty>
+    static inline void _Set_result_value( socket_result<_Ty>& _Result, int _Retval ) noexcept
+        {   // store value of the successful operation
+        _Result.value = static_cast<_Ty>(_Retval);
+        }
+
+    static inline void _Set_result_value( socket_result<void>&, int ) noexcept
+        {   // operations without value
+        }
+
+    _NODISCARD inline _Socket_handle _Accept_native( sockaddr* _Addr, _Sock_size_t* _Addrlen ) noexcept
+        {   // accept connection, accepted handle inherits blocking mode of the listener
+#   if defined( OS_LINUX )
+        return __impl::accept4( this->_MyHandle, _Addr, _Addrlen,
+            this->_MyNonblocking ? SOCK_NONBLOCK : 0 );
+#   else
+        return __impl::accept( this->_MyHandle, _Addr, _Addrlen );
+#   endif
+        }
+
+    inline int _Send_vec( const socket_buffer* _Buffers, size_t _Count, int _Flags ) noexcept
+        {   // send data gathered from the buffers
+#   if defined( OS_WINDOWS )
+        DWORD _Sent = 0;
+        if( ::WSASend( this->_MyHandle, reinterpret_cast<LPWSABUF>(const_cast<socket_buffer*>(_Buffers)),
+                static_cast<DWORD>(_Count), &_Sent, static_cast<DWORD>(_Flags), nullptr, nullptr ) != 0 )
+            return SOCKET_ERROR;
+        return static_cast<int>(_Sent);
+#   else
+        msghdr _Message;
+        __impl::memset( &_Message, 0, sizeof( _Message ) );
+        _Message.msg_iov = reinterpret_cast<iovec*>(const_cast<socket_buffer*>(_Buffers));
+        _Message.msg_iovlen = _Count;
+        return static_cast<int>(::sendmsg( this->_MyHandle, &_Message, _Flags ));
+#   endif
+        }
+
+    inline int _Recv_vec( socket_buffer* _Buffers, size_t _Count, int _Flags ) noexcept
+        {   // receive data scattered into the buffers
+#   if defined( OS_WINDOWS )
+        DWORD _Received = 0;
+        DWORD _Recv_flags = static_cast<DWORD>(_Flags);
+        if( ::WSARecv( this->_MyHandle, reinterpret_cast<LPWSABUF>(_Buffers),
+                static_cast<DWORD>(_Count), &_Received, &_Recv_flags, nullptr, nullptr ) != 0 )
+            return SOCKET_ERROR;
+        return static_cast<int>(_Received);
+#   else
+        msghdr _Message;
+        __impl::memset( &_Message, 0, sizeof( _Message ) );
+        _Message.msg_iov = reinterpret_cast<iovec*>(_Buffers);
+        _Message.msg_iovlen = _Count;
+        return static_cast<int>(::recvmsg( this->_MyHandle, &_Message, _Flags ));
+#   endif
+        }
+
+#if defined( OS_LINUX )
+    inline int _Splice_file( int _File, off_t _Offset, size_t _Length, size_t& _Sent ) noexcept
+        {   // send file through a pipe, returns error which stopped the transfer
+        // Non-blocking socket uses its own pipe, data it does not take is left there for
+        // the next call. Otherwise the pipe of the calling thread is used and left empty.
+        _Splice_pipe* _Pipe;
+        _Splice_transfer* _Transfer = nullptr;
+        try
+            {
+            if( this->_MyNonblocking && this->_MyFile_transfer == nullptr )
+                this->_MyFile_transfer.reset( new _Splice_transfer() );
+            _Transfer = this->_MyFile_transfer.get();
+            _Pipe = (_Transfer != nullptr) ? &_Transfer->_Pipe : &_Splice_pipe::_Get();
+            }
+        catch( const socket_exception& _Exception )
+            {
+            return _Exception.code().value();
+            }
+        catch( ... )
+            {
+            return ENOMEM;
+            }
+        size_t _Done = 0;
+        while( _Done < _Length )
+            {
+            loff_t _Position = static_cast<loff_t>(_Offset) + static_cast<loff_t>(_Done);
+            const ssize_t _Filled = ::splice( _File, &_Position, _Pipe->_Write, nullptr,
+                __impl::min( _Length - _Done, static_cast<size_t>(_Splice_pipe::_Capacity) ), SPLICE_F_MOVE );
+            if( _Filled == 0 )
+                break; // end of file
+            if( _Filled < 0 )
+                {
+                if( errno == EINTR )
+                    continue;
+                _Sent += _Done;
+                return errno;
+                }
+            size_t _Left = static_cast<size_t>(_Filled);
+            const int _Errval = _Drain_splice_pipe( *_Pipe, _Left );
+            if( _Errval == 0 )
+                {
+                _Done += static_cast<size_t>(_Filled);
+                continue;
+                }
+            if( _Transfer != nullptr && _Is_would_block( _Errval ) )
+                { // data has been consumed from the file, the next call sends the rest
+                _Transfer->_Pending = _Left;
+                _Sent += _Done + static_cast<size_t>(_Filled);
+                return _Errval;
+                }
+            try { _Pipe->_Reset(); }
+            catch( ... ) {}
+            _Sent += _Done + (static_cast<size_t>(_Filled) - _Left);
+            return _Errval;
+            }
+        _Sent += _Done;
+        return 0;
+        }
+
+    inline int _Flush_file_transfer() noexcept
+        {   // send data left in the pipe by the previous send_file, returns error which stopped it
+        _Splice_transfer* const _Transfer = this->_MyFile_transfer.get();
+        if( _Transfer == nullptr || _Transfer->_Pending == 0 )
+            return 0;
+        const int _Errval = _Drain_splice_pipe( _Transfer->_Pipe, _Transfer->_Pending );
+        if( _Errval != 0 && !_Is_would_block( _Errval ) )
+            { // connection failed, the data cannot be delivered
+            _Transfer->_Pending = 0;
+            try { _Transfer->_Pipe._Reset(); }
+            catch( ... ) { this->_MyFile_transfer.reset(); }
+            }
+        return _Errval;
+        }
+
+    inline int _Drain_splice_pipe( _Splice_pipe& _Pipe, size_t& _Left ) noexcept
+        {   // move _Left bytes from the pipe into the socket, returns error which stopped it
+        while( _Left > 0 )
+            {
+            const ssize_t _Retval = ::splice( _Pipe._Read, nullptr, this->_MyHandle, nullptr,
+                _Left, SPLICE_F_MOVE );
+            if( _Retval > 0 )
+                {
+                _Left -= static_cast<size_t>(_Retval);
+                continue;
+                }
+            if( _Retval < 0 && errno == EINTR )
+                continue;
+            return (_Retval < 0) ? errno : EPIPE;
+            }
+        return 0;
+        }
+
+    inline int _Send_segmented( const void* _Data, size_t _ByteSize, size_t _Segment_size,
+            const sockaddr* _Addr, size_t _Addrlen, int _Flags ) noexcept
+        {   // send buffer with UDP_SEGMENT control message, segment size must fit into 16 bits
+        iovec _Buffer;
+        _Buffer.iov_base = const_cast<void*>(_Data);
+        _Buffer.iov_len = _ByteSize;
+        alignas( cmsghdr ) char _Control[CMSG_SPACE( sizeof( std::uint16_t ) )];
+        __impl::memset( _Control, 0, sizeof( _Control ) );
+        msghdr _Message;
+        __impl::memset( &_Message, 0, sizeof( _Message ) );
+        _Message.msg_name = const_cast<sockaddr*>(_Addr);
+        _Message.msg_namelen = static_cast<socklen_t>(_Addrlen);
+        _Message.msg_iov = &_Buffer;
+        _Message.msg_iovlen = 1;
+        _Message.msg_control = _Control;
+        _Message.msg_controllen = sizeof( _Control );
+        cmsghdr* _Cmsg = CMSG_FIRSTHDR( &_Message );
+        _Cmsg->cmsg_level = IPPROTO_UDP;
+        _Cmsg->cmsg_type = UDP_SEGMENT;
+        _Cmsg->cmsg_len = CMSG_LEN( sizeof( std::uint16_t ) );
+        const std::uint16_t _Segment = static_cast<std::uint16_t>(_Segment_size);
+        __impl::memcpy( CMSG_DATA( _Cmsg ), &_Segment, sizeof( _Segment ) );
+        return static_cast<int>(::sendmsg( this->_MyHandle, &_Message, _Flags ));
+        }
+
+    inline int _Recv_segmented( void* _Data, size_t _ByteSize, size_t* _Segment_size,
+            sockaddr* _Addr, size_t* _Addrlen, int _Flags ) noexcept
+        {   // receive buffer and UDP_GRO control message
+        iovec _Buffer;
+        _Buffer.iov_base = _Data;
+        _Buffer.iov_len = _ByteSize;
+        alignas( cmsghdr ) char _Control[CMSG_SPACE( sizeof( int ) )];
+        msghdr _Message;
+        __impl::memset( &_Message, 0, sizeof( _Message ) );
+        _Message.msg_name = _Addr;
+        _Message.msg_namelen = static_cast<socklen_t>(_Static_optional_or_default<size_t>( _Addrlen, 0 ));
+        _Message.msg_iov = &_Buffer;
+        _Message.msg_iovlen = 1;
+        _Message.msg_control = _Control;
+        _Message.msg_controllen = sizeof( _Control );
+        const int _Retval = static_cast<int>(::recvmsg( this->_MyHandle, &_Message, _Flags ));
+        if( _Retval < 0 )
+            return _Retval;
+        size_t _Segment = static_cast<size_t>(_Retval);
+        for( cmsghdr* _Cmsg = CMSG_FIRSTHDR( &_Message ); _Cmsg != nullptr; _Cmsg = CMSG_NXTHDR( &_Message, _Cmsg ) )
+            {
+            if( _Cmsg->cmsg_level == IPPROTO_UDP && _Cmsg->cmsg_type == UDP_GRO )
+                {
+                int _Gro_size = 0;
+                __impl::memcpy( &_Gro_size, CMSG_DATA( _Cmsg ), sizeof( _Gro_size ) );
+                _Segment = static_cast<size_t>(_Gro_size);
+                }
+            }
+        if( _Segment_size != nullptr )
+            (*_Segment_size) = _Segment;
+        if( _Addrlen != nullptr )
+            (*_Addrlen) = static_cast<size_t>(_Message.msg_namelen);
+        return _Retval;
+        }
+
+    static constexpr size_t _Batch_size = 64; // datagrams passed to a single system call
+
+    inline int _Recv_batch( socket_datagram* _Datagrams, size_t _Count, int _Flags ) noexcept
+        {   // receive at most _Batch_size datagrams, waiting at most for the first one
+        mmsghdr _Headers[socket::_Batch_size];
+        iovec _Buffers[socket::_Batch_size];
+        __impl::memset( _Headers, 0, sizeof( mmsghdr ) * _Count );
+        for( size_t i = 0; i < _Count; ++i )
+            {
+            _Buffers[i].iov_base = _Datagrams[i].data;
+            _Buffers[i].iov_len = _Datagrams[i].size;
+            _Headers[i].msg_hdr.msg_iov = &_Buffers[i];
+            _Headers[i].msg_hdr.msg_iovlen = 1;
+            _Headers[i].msg_hdr.msg_name = _Datagrams[i].address._Data();
+            _Headers[i].msg_hdr.msg_namelen = sizeof( sockaddr_storage );
+            }
+        const int _Retval = ::recvmmsg( this->_MyHandle, _Headers, static_cast<unsigned int>(_Count),
+            _Flags | MSG_WAITFORONE, nullptr );
+        for( int i = 0; i < _Retval; ++i )
+            {
+            _Datagrams[i].length = _Headers[i].msg_len;
+            _Datagrams[i].address._Set_size( _Headers[i].msg_hdr.msg_namelen );
+            _Datagrams[i].truncated = (_Headers[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+            }
+        return _Retval;
+        }
+
+    inline int _Send_batch( socket_datagram* _Datagrams, size_t _Count, int _Flags ) noexcept
+        {   // send at most _Batch_size datagrams
+        mmsghdr _Headers[socket::_Batch_size];
+        iovec _Buffers[socket::_Batch_size];
+        __impl::memset( _Headers, 0, sizeof( mmsghdr ) * _Count );
+        for( size_t i = 0; i < _Count; ++i )
+            {
+            const size_t _Addrlen = _Datagrams[i].address.get_native_sockaddr_size();
+            _Buffers[i].iov_base = _Datagrams[i].data;
+            _Buffers[i].iov_len = _Datagrams[i].size;
+            _Headers[i].msg_hdr.msg_iov = &_Buffers[i];
+            _Headers[i].msg_hdr.msg_iovlen = 1;
+            _Headers[i].msg_hdr.msg_name = (_Addrlen != 0) ? _Datagrams[i].address._Data() : nullptr;
+            _Headers[i].msg_hdr.msg_namelen = static_cast<socklen_t>(_Addrlen);
+            }
+        const int _Retval = ::sendmmsg( this->_MyHandle, _Headers, static_cast<unsigned int>(_Count),
+            _Flags | MSG_NOSIGNAL );
+        for( int i = 0; i < _Retval; ++i )
+            _Datagrams[i].length = _Headers[i].msg_len;
+        return _Retval;
+        }
+
+    _NODISCARD static inline std::vector<socket_datagram>& _Get_batch_datagrams( size_t _Count )
+        {   // get datagram descriptors of the calling thread, reused by io_buffer batches
+        thread_local std::vector<socket_datagram> _Datagrams;
+        if( _Datagrams.size() < _Count )
+            _Datagrams.resize( _Count );
+        return _Datagrams;
+        }
+#endif
+
+    _NODISCARD inline socket _Make_accepted( _Socket_handle _Handle ) const noexcept
+        {   // construct accepted socket with the listener's properties
+        socket _Accepted( _Handle, this->_MyAddr_family, this->_MyType, this->_MyProtocol );
+        _Accepted._MyAddrinfo = this->_MyAddrinfo;
+        _Accepted._MyNonblocking = this->_MyNonblocking;
+        return _Accepted;
+        }
+
     template<typename _Ty>
     inline _Ty& _Throw_if_failed( _Ty&& _Retval ) const
         {   // throw exception if _Retval indicates error
@@ -1502,6 +3185,13 @@ private:
             }
         }
 
+private: // platform-dependent send flags
+#if defined( OS_LINUX )
+    static constexpr int _Send_nosignal = MSG_NOSIGNAL;
+#else
+    static constexpr int _Send_nosignal = 0;
+#endif
+
 private: // platform-dependent shutdown values
 #if defined( OS_WINDOWS )
     static constexpr int _Shut_in = SD_RECEIVE;
@@ -1517,6 +3207,13 @@ private: // platform-dependent shutdown values
 
     template<typename _Elem, typename _Traits>
     friend class basic_socketstream;
+    template<typename _Elem, typename _Traits>
+    friend class basic_socketbuf;
+    friend class socket_proactor;
+    friend class socket_reactor;
+#if defined( _LIBSOCK_HAS_COROUTINES )
+    friend class _Socket_io_awaitable;
+#endif
     };
 
 template<>
@@ -1563,6 +3260,209 @@ inline void swap( socket& _Left, socket& _Right ) noexcept
     }
 
 
+// STRUCT accepted_socket
+struct accepted_socket
+    {   // connection accepted by socket::accept_batch
+    socket connection;
+    socket_address_storage peer;
+    };
+
+
+inline std::vector<accepted_socket> socket::accept_batch( size_t _Max_count )
+    {   // accept up to _Max_count pending connections
+    // Drains the accept queue until it reports "would block". Accepted sockets are
+    // always non-blocking and close-on-exec, on Linux both flags are applied by
+    // accept4 without additional calls. If the listener itself is blocking, only
+    // the first accept may wait for the connection, the remaining ones are issued
+    // only while the queue is known to be non-empty.
+    _LIBSOCK_CHECK_ARG_NOT_EQ( _Max_count, 0 );
+    std::vector<accepted_socket> _Accepted;
+    while( _Accepted.size() < _Max_count )
+        {
+        if( !this->_MyNonblocking && !_Accepted.empty() )
+            { // do not block once at least one connection has been accepted
+            pollfd _Pollfd{};
+            _Pollfd.fd = this->_MyHandle;
+            _Pollfd.events = POLLIN;
+            if( __impl::poll( &_Pollfd, 1, 0 ) <= 0 )
+                break;
+            }
+        sockaddr_storage _Addr;
+        _Sock_size_t _Addrlen = sizeof( _Addr );
+#   if defined( OS_LINUX )
+        _Socket_handle _Handle = __impl::accept4( this->_MyHandle,
+            reinterpret_cast<sockaddr*>(&_Addr), &_Addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC );
+#   else
+        _Socket_handle _Handle = __impl::accept( this->_MyHandle,
+            reinterpret_cast<sockaddr*>(&_Addr), &_Addrlen );
+#   endif
+        if( _Handle == _Invalid_socket )
+            {
+            const int _Errval = __impl::geterror( -1 );
+#   if defined( OS_LINUX )
+            if( _Errval == ECONNABORTED || _Errval == EINTR )
+                continue; // connection reset while in the queue
+#   endif
+            if( _Is_would_block( _Errval ) )
+                break;
+            if( _Accepted.empty() )
+                throw socket_exception( _Errval );
+            break; // report the error on the next call
+            }
+        socket _Connection( _Handle, this->_MyAddr_family, this->_MyType, this->_MyProtocol );
+        _Connection._MyAddrinfo = this->_MyAddrinfo;
+#   if defined( OS_LINUX )
+        _Connection._MyNonblocking = true;
+#   else
+        _Connection.set_nonblocking( true );
+#   endif
+        _Accepted.push_back( accepted_socket{ __impl::move( _Connection ),
+            socket_address_storage( reinterpret_cast<const sockaddr*>(&_Addr), _Addrlen ) } );
+        }
+    return _Accepted;
+    }
+
+
+_NODISCARD inline socket connect_any( const std::vector<socket_address_info>& _Addresses,
+    std::chrono::milliseconds _Attempt_delay = std::chrono::milliseconds( 250 ),
+    std::chrono::milliseconds _Timeout = std::chrono::milliseconds( 0 ) )
+    {   // connect to the first address that responds, racing staggered attempts (RFC 8305)
+    // Attempts alternate between address families, starting with the family of the
+    // first address. Next attempt starts after _Attempt_delay or as soon as one of the
+    // previous ones fails. Returned socket is in blocking mode, remaining attempts are
+    // closed. Zero _Timeout waits until all attempts fail.
+    typedef std::chrono::steady_clock _Clock;
+    if( _Addresses.empty() )
+        throw std::invalid_argument( "_Addresses cannot be empty" );
+    std::vector<const socket_address_info*> _Order;
+    _Order.reserve( _Addresses.size() );
+    {
+    std::vector<const socket_address_info*> _Primary, _Secondary;
+    for( const socket_address_info& _Addrinfo : _Addresses )
+        (_Addrinfo.family == _Addresses.front().family ? _Primary : _Secondary).push_back( &_Addrinfo );
+    for( size_t i = 0; i < __impl::max( _Primary.size(), _Secondary.size() ); ++i )
+        {
+        if( i < _Primary.size() )
+            _Order.push_back( _Primary[i] );
+        if( i < _Secondary.size() )
+            _Order.push_back( _Secondary[i] );
+        }
+    }
+#if defined( OS_WINDOWS )
+    int _Errval = WSAETIMEDOUT;
+#else
+    int _Errval = ETIMEDOUT;
+#endif
+    const _Clock::time_point _Deadline = _Clock::now() + _Timeout;
+    _Clock::time_point _Next_start = _Clock::now();
+    std::vector<socket> _Attempts;
+    std::vector<pollfd> _Pollfds;
+    size_t _Next = 0;
+    for( ;; )
+        {
+        _Clock::time_point _Now = _Clock::now();
+        if( _Next < _Order.size() && (_Now >= _Next_start || _Attempts.empty()) )
+            { // start next attempt
+            const socket_address_info& _Addrinfo = *_Order[_Next++];
+            try
+                {
+                socket _Socket( _Addrinfo, socket_mode::nonblocking );
+                const socket_result<void> _Result = _Socket.connect( _Addrinfo.addr, std::nothrow );
+                if( _Result )
+                    { // connected immediately
+                    _Socket.set_nonblocking( false );
+                    return _Socket;
+                    }
+                if( _Result.would_block )
+                    {
+                    pollfd _Pollfd{};
+                    _Pollfd.fd = _Socket.get_native_handle();
+                    _Pollfd.events = POLLOUT;
+                    _Pollfds.push_back( _Pollfd );
+                    _Attempts.push_back( __impl::move( _Socket ) );
+                    _Next_start = _Now + _Attempt_delay;
+                    }
+                else _Errval = _Result.error.value();
+                }
+            catch( const socket_exception& _Exception )
+                { // e.g. address family not available on this host
+                _Errval = _Exception.code().value();
+                }
+            continue;
+            }
+        if( _Attempts.empty() )
+            throw socket_exception( _Errval );
+        _Clock::time_point _Wake_time = _Clock::time_point::max();
+        if( _Next < _Order.size() )
+            _Wake_time = _Next_start;
+        if( _Timeout.count() > 0 )
+            {
+            if( _Now >= _Deadline )
+#if defined( OS_WINDOWS )
+                throw socket_exception( WSAETIMEDOUT );
+#else
+                throw socket_exception( ETIMEDOUT );
+#endif
+            _Wake_time = __impl::min( _Wake_time, _Deadline );
+            }
+        int _Wait_ms = -1;
+        if( _Wake_time != _Clock::time_point::max() )
+            {
+            _Wait_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                _Wake_time - _Now + std::chrono::milliseconds( 1 ) - _Clock::duration( 1 )).count());
+            }
+        const int _Ready = __impl::poll( _Pollfds.data(), static_cast<unsigned long>(_Pollfds.size()), _Wait_ms );
+        if( _Ready < 0 )
+            {
+            const int _Poll_error = __impl::geterror( _Ready );
+#if defined( OS_LINUX )
+            if( _Poll_error == EINTR )
+                continue;
+#endif
+            throw socket_exception( _Poll_error );
+            }
+        for( size_t i = 0; _Ready > 0 && i < _Attempts.size(); )
+            {
+            if( _Pollfds[i].revents == 0 )
+                {
+                ++i;
+                continue;
+                }
+            int _Status = 0;
+            _Attempts[i].get_opt( socket_opt::error, _Status );
+            if( _Status == 0 )
+                { // the winner, remaining attempts are closed on return
+                _Attempts[i].set_nonblocking( false );
+                return __impl::move( _Attempts[i] );
+                }
+            _Errval = _Status;
+            _Attempts.erase( _Attempts.begin() + i );
+            _Pollfds.erase( _Pollfds.begin() + i );
+            _Next_start = _Now; // failed attempt does not delay the next one
+            }
+        }
+    }
+
+
+_NODISCARD inline socket connect_any(
+    const std::string& _Hostname,
+    const std::string& _Svc_name,
+    const socket_address_info& _Hints,
+    std::chrono::milliseconds _Attempt_delay = std::chrono::milliseconds( 250 ),
+    std::chrono::milliseconds _Timeout = std::chrono::milliseconds( 0 ) )
+    {   // resolve the name and connect to the first address that responds
+    return connect_any( get_socket_address_info_list( _Hostname, _Svc_name, _Hints ), _Attempt_delay, _Timeout );
+    }
+
+
+#if defined( _LIBSOCK_HAS_COROUTINES )
+template<typename _Elem, typename _Traits>
+class _Socketstream_send_awaitable;
+template<typename _Elem, typename _Traits, typename _Ty>
+class _Socketstream_recv_awaitable;
+#endif
+
+
 // CLASS socketstream
 template<typename _Elem, typename _Traits = std::char_traits<_Elem>>
 class basic_socketstream
@@ -1571,6 +3471,7 @@ class basic_socketstream
 public:
     static constexpr int text = 0;
     static constexpr int binary = 1;
+    static constexpr int framed = 3;    // binary, strings and vectors prefixed with length
 
 private:
     static constexpr int _mode_default = basic_socketstream::binary;
@@ -1582,13 +3483,29 @@ public:
         : _MyBase()
         , _MySocket()
         , _MyMode( basic_socketstream::_mode_default )
+        , _MyWrite_buffer()
+        , _MyWrite_limit( 0 )
+        , _MyCork( false )
+        , _MyCorked( false )
+        , _MyRead_buffer()
+        , _MyRead_first( 0 )
+        , _MyRead_last( 0 )
         {   // construct uninitialized socket stream
+        _Init_format();
         }
 
     inline basic_socketstream( socket& _Socket, int _Mode = basic_socketstream::_mode_default )
         : _MySocket( &_Socket )
         , _MyMode( _Mode )
+        , _MyWrite_buffer()
+        , _MyWrite_limit( 0 )
+        , _MyCork( false )
+        , _MyCorked( false )
+        , _MyRead_buffer()
+        , _MyRead_first( 0 )
+        , _MyRead_last( 0 )
         {   // construct socket stream from socket object
+        _Init_format();
         if( !this->_MySocket->_Is_stream_socket() )
             {
             throw std::invalid_argument( "cannot create stream from non-stream socket" );
@@ -1599,15 +3516,102 @@ public:
         {   // exchange socket streams
         __impl::swap( this->_MySocket, _Other._MySocket );
         __impl::swap( this->_MyMode, _Other._MyMode );
+        this->_MyWrite_buffer.swap( _Other._MyWrite_buffer );
+        __impl::swap( this->_MyWrite_limit, _Other._MyWrite_limit );
+        __impl::swap( this->_MyCork, _Other._MyCork );
+        __impl::swap( this->_MyCorked, _Other._MyCorked );
+        this->_MyRead_buffer.swap( _Other._MyRead_buffer );
+#if defined( OS_LINUX )
+        this->_MyRead_mirror._Swap( _Other._MyRead_mirror );
+#endif
+        __impl::swap( this->_MyRead_first, _Other._MyRead_first );
+        __impl::swap( this->_MyRead_last, _Other._MyRead_last );
         ios_base::swap( _Other );
         }
-    
+
+    inline void set_write_buffer( size_t _Size )
+        {   // coalesce written values, flush automatically once _Size bytes are pending
+        // Buffering is disabled by default (_Size 0), each value is then sent immediately.
+        // Pending data is not sent on destruction, call flush() while the socket is alive.
+        if( this->_MyWrite_buffer.size() >= _Size )
+            flush();
+        this->_MyWrite_limit = _Size;
+        this->_MyWrite_buffer.reserve( _Size );
+        }
+
+    _NODISCARD inline size_t write_buffer_size() const noexcept
+        {   // get number of bytes which trigger automatic flush, 0 if writes are not buffered
+        return this->_MyWrite_limit;
+        }
+
+    _NODISCARD inline size_t pending_write_size() const noexcept
+        {   // get number of buffered bytes which have not been sent yet
+        return this->_MyWrite_buffer.size();
+        }
+
+    _NODISCARD inline size_t pending_read_size() const noexcept
+        {   // get number of received bytes which have not been consumed yet
+        // The stream receives ahead, so the socket should not be read directly while
+        // the stream is in use.
+        return this->_MyRead_last - this->_MyRead_first;
+        }
+
+#if defined( OS_LINUX )
+    inline void set_mirrored_read_buffer( size_t _Capacity = 64 * 1024 )
+        {   // receive into ring buffer mapped twice, received values are never moved
+        // Values wrapping around the end of the buffer are contiguous, so they are neither
+        // copied nor parsed in parts. Buffer grows only if single value does not fit.
+        _Reset_mirrored_read_buffer( _Capacity );
+        }
+
+    _NODISCARD inline bool is_read_buffer_mirrored() const noexcept
+        {   // check if the read buffer is mapped twice
+        return this->_MyRead_mirror._Data() != nullptr;
+        }
+
+    inline void set_cork( bool _Cork = true ) noexcept
+        {   // send data with MSG_MORE until explicit flush, so that the kernel sends full segments
+        // Applies to automatic flushes and to values sent without buffering. flush() pushes
+        // all pending segments out, uncorking the socket (TCP_CORK) if nothing is buffered.
+        this->_MyCork = _Cork;
+        }
+
+    _NODISCARD inline bool is_corked() const noexcept
+        {   // check if data is sent with MSG_MORE until explicit flush
+        return this->_MyCork;
+        }
+#endif
+
+    inline basic_socketstream& flush()
+        {   // send buffered data
+        _Throw_if_uninitialized();
+        if( !this->_MyWrite_buffer.empty() )
+            _Send_write_buffer( false );
+#if defined( OS_LINUX )
+        else if( this->_MyCorked )
+            { // last data has been sent with MSG_MORE, uncorking pushes it out
+            this->_MySocket->set_opt( socket_opt_tcp::cork, false );
+            }
+#endif
+        this->_MyCorked = false;
+        return (*this);
+        }
+
     inline basic_socketstream& operator<<( std::ios_base& (&_Mod)(std::ios_base&) )
         {   // set format flag
         _Mod( *this );
         return (*this);
         }
 
+    inline basic_socketstream& operator<<( std::basic_ostream<_Elem, _Traits>& (*_Manip)(std::basic_ostream<_Elem, _Traits>&) )
+        {   // flush the stream on std::flush and std::endl
+        // Values are delimited by the stream format, std::endl does not send new line.
+        if( _Manip == static_cast<std::basic_ostream<_Elem, _Traits>& (*)(std::basic_ostream<_Elem, _Traits>&)>(&std::flush)
+            || _Manip == static_cast<std::basic_ostream<_Elem, _Traits>& (*)(std::basic_ostream<_Elem, _Traits>&)>(&std::endl) )
+            return flush();
+        throw std::invalid_argument( "unsupported stream manipulator" );
+        }
+
     inline basic_socketstream& operator<<( short _Val )
         { // send 16-bit signed integer
         return _Common_send_arithmetic( _Val );
@@ -1651,22 +3655,21 @@ public:
     inline basic_socketstream& operator<<( const std::basic_string<_Elem, _Traits>& _Val )
         {   // send string
         _Throw_if_uninitialized();
+        if( _Is_framed() )
+            return _Write_framed( _Val.data(), _Val.length(), sizeof( _Elem ) );
         const _Elem* _Val_buffer = _Val.c_str();
         const size_t _Val_buffer_size = sizeof( _Elem ) * (_Val.length() + 1);
-        this->_MySocket->send( _Val_buffer, _Val_buffer_size );
+        _Write( _Val_buffer, _Val_buffer_size );
         return (*this);
         }
 
     inline basic_socketstream& operator<<( const _Elem* _Str )
         {   // send wide C-style string
         _Throw_if_uninitialized();
-        const size_t _Str_size = sizeof( _Elem );
-        if _CONSTEXPR_IF( sizeof( _Elem ) == sizeof( wchar_t ) )
-            _Str_size *= __impl::wcslen( _Str ) + 1;
-        else if _CONSTEXPR_IF( sizeof( _Elem ) == sizeof( char ) )
-            _Str_size *= __impl::strlen( _Str ) + 1;
-        else throw std::runtime_error( "unsupported char type" );
-        this->_MySocket->send( _Str, _Str_size );
+        _LIBSOCK_CHECK_ARG_NOT_NULL( _Str );
+        if( _Is_framed() )
+            return _Write_framed( _Str, _Traits::length( _Str ), sizeof( _Elem ) );
+        _Write( _Str, sizeof( _Elem ) * (_Traits::length( _Str ) + 1) );
         return (*this);
         }
 
@@ -1674,7 +3677,31 @@ public:
     inline basic_socketstream& operator<<( const _Elem (&_Str)[_Size] )
         {   // send C-style string
         _Throw_if_uninitialized();
-        this->_MySocket->send( _Str, _Size * sizeof( _Elem ) );
+        if( _Is_framed() )
+            { // send characters up to the terminator
+            const _Elem* const _End = _Traits::find( _Str, _Size, _Elem() );
+            return _Write_framed( _Str, (_End != nullptr) ? static_cast<size_t>(_End - _Str) : _Size, sizeof( _Elem ) );
+            }
+        _Write( _Str, _Size * sizeof( _Elem ) );
+        return (*this);
+        }
+
+    template<typename _Ty, typename _Alloc>
+    inline basic_socketstream& operator<<( const std::vector<_Ty, _Alloc>& _Val )
+        {   // send vector of arithmetic values as single frame (framed mode only)
+        static_assert( std::is_arithmetic<_Ty>::value && !std::is_same<_Ty, bool>::value,
+            "only vectors of arithmetic types are supported" );
+        _Throw_if_uninitialized();
+        _Throw_if_not_framed();
+        return _Write_framed( _Val.data(), _Val.size(), sizeof( _Ty ) );
+        }
+
+    inline basic_socketstream& operator<<( const io_buffer& _Val )
+        {   // send valid bytes of the pooled buffer, as single frame in framed mode
+        _Throw_if_uninitialized();
+        if( _Is_framed() )
+            return _Write_framed( _Val.data(), _Val.size(), 1 );
+        _Write( _Val.data(), _Val.size() );
         return (*this);
         }
 
@@ -1729,106 +3756,770 @@ public:
         return _Common_recv_string( _Val );
         }
 
-    template<size_t _Size>
-    inline basic_socketstream& operator>>( _Elem (&_Str)[_Size] )
-        {   // receive wide C-style string
-        std::basic_string<_Elem, _Traits> _Str_buffer;
-        _Common_recv_string( _Str_buffer, _Size );
-        if _CONSTEXPR_IF( sizeof( _Elem ) == sizeof( wchar_t ) )
+    template<typename _Ty, typename _Alloc>
+    inline basic_socketstream& operator>>( std::vector<_Ty, _Alloc>& _Val )
+        {   // receive vector of arithmetic values sent as single frame (framed mode only)
+        static_assert( std::is_arithmetic<_Ty>::value && !std::is_same<_Ty, bool>::value,
+            "only vectors of arithmetic types are supported" );
+        _Throw_if_uninitialized();
+        _Throw_if_not_framed();
+        const size_t _Count = _Read_length( sizeof( _Ty ) );
+        _Val.resize( _Count );
+        _Read_direct( _Val.data(), _Count * sizeof( _Ty ) );
+        return (*this);
+        }
+
+    inline basic_socketstream& operator>>( io_buffer& _Val )
+        {   // receive frame into the pooled buffer, or exactly size() bytes if the stream is not framed
+        _Throw_if_uninitialized();
+        if( _Is_framed() )
             {
-            __impl::wcscpy(
-                reinterpret_cast<_Elem[_Size]>(_Str),
-                reinterpret_cast<const _Elem*>(_Str_buffer.c_str()) );
+            const size_t _Length = _Read_length( 1 );
+            if( _Length > _Val.capacity() )
+                throw std::runtime_error( "frame exceeds capacity of the buffer" );
+            _Val.resize( _Length );
             }
-        else if _CONSTEXPR_IF( sizeof( _Elem ) == sizeof( char ) )
+        if( !_Val.empty() )
+            _Read_direct( _Val.data(), _Val.size() );
+        return (*this);
+        }
+
+    template<size_t _Size>
+    inline basic_socketstream& operator>>( _Elem (&_Str)[_Size] )
+        {   // receive C-style string, copied directly from the read buffer
+        _Throw_if_uninitialized();
+        if( _Is_framed() )
             {
-            __impl::strcpy(
-                reinterpret_cast<_Elem[_Size]>(_Str),
-                reinterpret_cast<const _Elem*>(_Str_buffer.c_str()) );
+            std::basic_string<_Elem, _Traits> _Str_buffer;
+            _Common_recv_string( _Str_buffer, _Size );
+            _Traits::copy( _Str, _Str_buffer.c_str(), _Str_buffer.length() + 1 );
+            return (*this);
             }
-        else throw std::runtime_error( "unsupported char type" );
+        const _Elem* _First;
+        size_t _Length;
+        size_t _Scanned = 0;
+        while( !_Find_string( _First, _Length, _Size, _Scanned ) )
+            _Fill_read_buffer_or_throw();
+        _Traits::copy( _Str, _First, _Length );
+        _Str[_Length] = _Elem();
+        this->_MyRead_first += (_Length + 1) * sizeof( _Elem );
         return (*this);
         }
 
-
-protected:
-    socket* _MySocket;
-    int _MyMode;
-
-    inline void _Throw_if_uninitialized()
-        {   // throw an exception if the stream has not been initialized
-        if( this->_MySocket == nullptr )
+#if defined( __cpp_lib_string_view )
+    _NODISCARD inline std::basic_string_view<_Elem, _Traits> recv_view()
+        {   // receive string as view of the read buffer, valid until the next extraction
+        _Throw_if_uninitialized();
+        if( _Is_framed() )
             {
-            throw std::runtime_error( "stream is not associated with any socket" );
+            const size_t _Length = _Read_length( sizeof( _Elem ) );
+            while( pending_read_size() < _Length * sizeof( _Elem ) )
+                _Fill_read_buffer_or_throw();
+            if( (this->_MyRead_first % alignof( _Elem )) != 0 )
+                _Compact_read_buffer();
+            const _Elem* const _First = reinterpret_cast<const _Elem*>(_Read_data() + this->_MyRead_first);
+            this->_MyRead_first += _Length * sizeof( _Elem );
+            return std::basic_string_view<_Elem, _Traits>( _First, _Length );
             }
+        const _Elem* _First;
+        size_t _Length;
+        size_t _Scanned = 0;
+        while( !_Find_string( _First, _Length, std::numeric_limits<size_t>::max(), _Scanned ) )
+            _Fill_read_buffer_or_throw();
+        this->_MyRead_first += (_Length + 1) * sizeof( _Elem );
+        return std::basic_string_view<_Elem, _Traits>( _First, _Length );
         }
+#endif
 
+#if defined( _LIBSOCK_HAS_COROUTINES )
+    // Awaitable counterparts of the stream operators, the socket must be attached to
+    // a reactor (see socket_reactor::attach). They bypass the write buffer, call flush first.
+    // Received values are taken from the read buffer shared with the stream operators.
     template<typename _Ty>
-    inline basic_socketstream& _Common_send_arithmetic( const _Ty& _Val,
+    _NODISCARD inline _Socketstream_send_awaitable<_Elem, _Traits> async_send( const _Ty& _Val,
             typename std::enable_if<std::is_arithmetic<_Ty>::value>::type* = nullptr )
-        {   // serialize arithmetic value
+        {   // send arithmetic value without blocking the thread
         _Throw_if_uninitialized();
         if( (this->_MyMode & basic_socketstream::binary) == basic_socketstream::binary )
-            { // binary serialization, send raw bytes
-            this->_MySocket->send( &_Val, sizeof( _Ty ) );
-            }
-        else
-            { // text serialization, send string representation
-            std::basic_string<_Elem, _Traits> _Val_str = (_Create_stringstream() << _Val).str();
-            this->_MySocket->send( _Val_str.c_str(), _Val_str.length() + 1 );
-            }
-        return (*this);
+            return _Socketstream_send_awaitable<_Elem, _Traits>( *this->_MySocket, _Val );
+        return _Socketstream_send_awaitable<_Elem, _Traits>( *this->_MySocket, _To_text( _Val ) );
         }
 
-    template<typename _Ty>
-    inline basic_socketstream& _Common_recv_arithmetic( _Ty& _Val,
-            typename std::enable_if<std::is_arithmetic<_Ty>::value>::type* = nullptr )
-        {   // deserialize arithmetic value
+    _NODISCARD inline _Socketstream_send_awaitable<_Elem, _Traits> async_send( const std::basic_string<_Elem, _Traits>& _Val )
+        {   // send string without blocking the thread, _Val must stay valid until completion
         _Throw_if_uninitialized();
-        if( (this->_MyMode & basic_socketstream::binary) == basic_socketstream::binary )
-            { // binary deserialization, recv raw bytes
-            this->_MySocket->recv( &_Val, sizeof( _Ty ) );
-            }
-        else
-            { // text deserialization, recv string representation
-            std::basic_string<_Elem, _Traits> _Val_str;
-            _Common_recv_string( _Val_str );
-            _Create_stringstream( _Val_str ) >> _Val;
-            }
-        return (*this);
+        if( _Is_framed() )
+            return _Socketstream_send_awaitable<_Elem, _Traits>( *this->_MySocket,
+                _Make_frame( _Val.data(), _Val.length(), sizeof( _Elem ) ) );
+        return _Socketstream_send_awaitable<_Elem, _Traits>( *this->_MySocket,
+            _Val.c_str(), sizeof( _Elem ) * (_Val.length() + 1) );
         }
 
-    inline basic_socketstream& _Common_recv_string( std::basic_string<_Elem, _Traits>& _Str,
-            size_t _Maxlen = std::numeric_limits<size_t>::max() )
-        {   // receive string value
+    _NODISCARD inline _Socketstream_send_awaitable<_Elem, _Traits> async_send( const _Elem* _Str )
+        {   // send C-style string without blocking the thread, _Str must stay valid until completion
         _Throw_if_uninitialized();
-        std::basic_stringstream<_Elem, _Traits> _Str_stream;
-        std::vector<_Elem> _Str_buffer( 1024 );
-        bool _Has_end = false;
-        while( !_Has_end )
-            { // read stream until terminator is found
-            _Elem* _Str_buffer_ptr = _Str_buffer.data();
-            size_t _Str_buffer_len = _Str_buffer.size() - 1;
-            size_t _Str_buffer_size = _Str_buffer_len * sizeof( _Elem );
-            // dont remove message from the queue yet
-            this->_MySocket->recv( _Str_buffer_ptr, _Str_buffer_size, socket_recv_flags::peek );
-            _Str_buffer_ptr[_Str_buffer_len] = 0;
-            const _Elem* p = _Str_buffer_ptr;
-            while( ((*p) != (_Elem)(0)) ) ++p;
-            if( p != _Str_buffer_ptr + _Str_buffer_len )
-                { // end of string found, add terminator
-                _Str_buffer.resize( static_cast<size_t>(p - _Str_buffer_ptr) / sizeof( _Elem ) + 1 );
-                _Has_end = true;
+        _LIBSOCK_CHECK_ARG_NOT_NULL( _Str );
+        if( _Is_framed() )
+            return _Socketstream_send_awaitable<_Elem, _Traits>( *this->_MySocket,
+                _Make_frame( _Str, _Traits::length( _Str ), sizeof( _Elem ) ) );
+        return _Socketstream_send_awaitable<_Elem, _Traits>( *this->_MySocket,
+            _Str, sizeof( _Elem ) * (_Traits::length( _Str ) + 1) );
+        }
+
+    template<typename _Ty>
+    _NODISCARD inline _Socketstream_recv_awaitable<_Elem, _Traits, _Ty> async_recv( _Ty& _Val )
+        {   // receive arithmetic value or string without blocking the thread
+        static_assert( std::is_arithmetic<_Ty>::value || std::is_same<_Ty, std::basic_string<_Elem, _Traits>>::value,
+            "async_recv supports arithmetic types and strings" );
+        _Throw_if_uninitialized();
+        return _Socketstream_recv_awaitable<_Elem, _Traits, _Ty>( *this, _Val );
+        }
+#endif
+
+protected:
+    socket* _MySocket;
+    int _MyMode;
+    std::vector<char> _MyWrite_buffer;
+    size_t _MyWrite_limit;  // flush threshold, 0 if writes are not buffered
+    bool _MyCork;           // send with MSG_MORE until explicit flush
+    bool _MyCorked;         // data has been sent with MSG_MORE since last flush
+    std::vector<char> _MyRead_buffer;
+#if defined( OS_LINUX )
+    _Mirrored_memory _MyRead_mirror;    // read buffer mapped twice, replaces _MyRead_buffer if set
+#endif
+    size_t _MyRead_first;   // first received byte which has not been consumed yet
+    size_t _MyRead_last;    // end of received data
+
+    static constexpr size_t _Read_chunk = 4096;
+
+#if defined( _LIBSOCK_HAS_COROUTINES )
+    template<typename, typename, typename>
+    friend class _Socketstream_recv_awaitable;
+#endif
+
+    inline void _Init_format() noexcept
+        {   // set default format flags and precision, like basic_ios::init
+        flags( _MyBase::skipws | _MyBase::dec );
+        precision( 6 );
+        width( 0 );
+        }
+
+    inline void _Throw_if_uninitialized()
+        {   // throw an exception if the stream has not been initialized
+        if( this->_MySocket == nullptr )
+            {
+            throw std::runtime_error( "stream is not associated with any socket" );
+            }
+        }
+
+    inline void _Send_all( const void* _Data, size_t _ByteSize, bool _More )
+        {   // send whole buffer
+        size_t _Sent = 0;
+        _Send_all( _Data, _ByteSize, _More, _Sent );
+        }
+
+    inline void _Send_all( const void* _Data, size_t _ByteSize, bool _More, size_t& _Sent )
+        {   // send whole buffer, _Sent tells how much has been sent if sending fails
+        _Socket_send_flags_helper _Flags = socket_send_flags::none;
+#if defined( OS_LINUX )
+        if( _More )
+            _Flags = socket_send_flags::more;
+#endif
+        const char* const _Bytes = static_cast<const char*>(_Data);
+        while( _Sent < _ByteSize )
+            _Sent += static_cast<size_t>(this->_MySocket->send( _Bytes + _Sent, _ByteSize - _Sent, _Flags ));
+        this->_MyCorked = this->_MyCorked || _More;
+        }
+
+    inline void _Send_all( socket_buffer* _Buffers, size_t _Count, bool _More )
+        {   // send whole contents of the buffers, descriptors are advanced over sent data
+        _Socket_send_flags_helper _Flags = socket_send_flags::none;
+#if defined( OS_LINUX )
+        if( _More )
+            _Flags = socket_send_flags::more;
+#endif
+        while( _Count > 0 )
+            {
+            size_t _Sent = static_cast<size_t>(this->_MySocket->send_vec( _Buffers, _Count, _Flags ));
+            for( ; _Count > 0 && _Sent >= static_cast<size_t>(_Buffers->size); ++_Buffers, --_Count )
+                _Sent -= static_cast<size_t>(_Buffers->size);
+            if( _Count > 0 )
+                { // buffer has been sent partially
+                _Buffers->data = reinterpret_cast<decltype(_Buffers->data)>(reinterpret_cast<char*>(_Buffers->data) + _Sent);
+                _Buffers->size -= static_cast<decltype(_Buffers->size)>(_Sent);
+                }
+            }
+        this->_MyCorked = this->_MyCorked || _More;
+        }
+
+    inline void _Send_write_buffer( bool _More )
+        {   // send buffered data, if sending fails only the part which has been sent is dropped
+        size_t _Sent = 0;
+        try
+            {
+            _Send_all( this->_MyWrite_buffer.data(), this->_MyWrite_buffer.size(), _More, _Sent );
+            }
+        catch( ... )
+            {
+            this->_MyWrite_buffer.erase( this->_MyWrite_buffer.begin(),
+                this->_MyWrite_buffer.begin() + static_cast<std::ptrdiff_t>(_Sent) );
+            throw;
+            }
+        this->_MyWrite_buffer.clear();
+        }
+
+    inline void _Write( const void* _Data, size_t _ByteSize )
+        {   // send or buffer serialized value
+        if( this->_MyWrite_limit == 0 )
+            _Send_all( _Data, _ByteSize, this->_MyCork );
+        else
+            {
+            if( this->_MyWrite_buffer.size() + _ByteSize > this->_MyWrite_limit
+                && !this->_MyWrite_buffer.empty() )
+                { // automatic flush, more data follows
+                _Send_write_buffer( this->_MyCork );
+                }
+            if( _ByteSize >= this->_MyWrite_limit )
+                _Send_all( _Data, _ByteSize, this->_MyCork );
+            else
+                {
+                const char* const _Bytes = static_cast<const char*>(_Data);
+                this->_MyWrite_buffer.insert( this->_MyWrite_buffer.end(), _Bytes, _Bytes + _ByteSize );
                 }
-            else _Str_buffer.resize( _Str_buffer.size() + 1024 );
             }
-        if( _Str_buffer.size() > _Maxlen )
-            { // insufficient buffer
+        if( (flags() & _MyBase::unitbuf) != 0 )
+            flush();
+        }
+
+    _NODISCARD inline char* _Read_data() noexcept
+        {   // get beginning of the read buffer
+#if defined( OS_LINUX )
+        if( this->_MyRead_mirror._Data() != nullptr )
+            return this->_MyRead_mirror._Data();
+#endif
+        return this->_MyRead_buffer.data();
+        }
+
+    inline socket_result<int> _Fill_read_buffer()
+        {   // receive available data at the end of the read buffer
+        // Data is received into the buffer in large chunks and each byte is received only
+        // once. Buffer grows geometrically, consumed data is dropped before growing.
+        if( this->_MyRead_first == this->_MyRead_last )
+            this->_MyRead_first = this->_MyRead_last = 0;
+#if defined( OS_LINUX )
+        if( this->_MyRead_mirror._Data() != nullptr )
+            return _Fill_mirrored_read_buffer();
+#endif
+        if( this->_MyRead_buffer.size() - this->_MyRead_last < _Read_chunk )
+            {
+            _Compact_read_buffer();
+            if( this->_MyRead_buffer.size() - this->_MyRead_last < _Read_chunk )
+                this->_MyRead_buffer.resize( __impl::max( this->_MyRead_buffer.size() * 2,
+                    this->_MyRead_last + _Read_chunk ) );
+            }
+        const size_t _Free = __impl::min( this->_MyRead_buffer.size() - this->_MyRead_last,
+            static_cast<size_t>(std::numeric_limits<int>::max()) );
+        const socket_result<int> _Result = this->_MySocket->recv(
+            this->_MyRead_buffer.data() + this->_MyRead_last, _Free, std::nothrow );
+        if( _Result )
+            this->_MyRead_last += static_cast<size_t>(_Result.value);
+        return _Result;
+        }
+
+    inline void _Fill_read_buffer_or_throw()
+        {   // receive more data, throw if the connection has been closed
+        const socket_result<int> _Result = _Fill_read_buffer();
+        if( _Result.error )
+            throw socket_exception( _Result.error.value() );
+        if( _Result.would_block )
+            throw socket_exception( EWOULDBLOCK );
+        if( _Result.value == 0 )
+            throw socket_exception( ECONNRESET ); // closed before whole value has been received
+        }
+
+#if defined( OS_LINUX )
+    inline socket_result<int> _Fill_mirrored_read_buffer()
+        {   // receive available data after the data which has not been consumed
+        // Unconsumed data is always contiguous, free space wraps around the end of the
+        // first view into the second one, so the buffer is never compacted.
+        size_t _Capacity = this->_MyRead_mirror._Size();
+        if( this->_MyRead_first >= _Capacity )
+            { // move positions back to the first view
+            this->_MyRead_first -= _Capacity;
+            this->_MyRead_last -= _Capacity;
+            }
+        if( this->_MyRead_last - this->_MyRead_first == _Capacity )
+            { // buffer is full, the value is larger than the buffer
+            _Reset_mirrored_read_buffer( 2 * _Capacity );
+            _Capacity = this->_MyRead_mirror._Size();
+            }
+        const size_t _Free = __impl::min( _Capacity - (this->_MyRead_last - this->_MyRead_first),
+            static_cast<size_t>(std::numeric_limits<int>::max()) );
+        const socket_result<int> _Result = this->_MySocket->recv(
+            this->_MyRead_mirror._Data() + this->_MyRead_last, _Free, std::nothrow );
+        if( _Result )
+            this->_MyRead_last += static_cast<size_t>(_Result.value);
+        return _Result;
+        }
+
+    inline void _Reset_mirrored_read_buffer( size_t _Capacity )
+        {   // move data which has not been consumed to new mirrored buffer
+        _LIBSOCK_CHECK_ARG_NOT_GREATER( _Capacity, _Mirrored_memory::_Max_size );
+        const size_t _Pending = this->_MyRead_last - this->_MyRead_first;
+        _Mirrored_memory _Mirror( _Mirrored_memory::_Round_size( __impl::max( _Capacity, _Pending ) ) );
+        if( _Pending != 0 )
+            __impl::memcpy( _Mirror._Data(), _Read_data() + this->_MyRead_first, _Pending );
+        this->_MyRead_mirror._Swap( _Mirror );
+        this->_MyRead_buffer = std::vector<char>();
+        this->_MyRead_first = 0;
+        this->_MyRead_last = _Pending;
+        }
+#endif
+
+    inline void _Compact_read_buffer()
+        {   // move data which has not been consumed to the beginning of the read buffer
+        if( this->_MyRead_first == 0 )
+            return;
+#if defined( OS_LINUX )
+        if( this->_MyRead_mirror._Data() != nullptr )
+            { // source may alias destination through the second view, copy through temporary buffer
+            char* const _Data = this->_MyRead_mirror._Data();
+            const std::vector<char> _Pending( _Data + this->_MyRead_first, _Data + this->_MyRead_last );
+            __impl::memcpy( _Data, _Pending.data(), _Pending.size() );
+            this->_MyRead_first = 0;
+            this->_MyRead_last = _Pending.size();
+            return;
+            }
+#endif
+        __impl::memmove( this->_MyRead_buffer.data(), _Read_data() + this->_MyRead_first,
+            this->_MyRead_last - this->_MyRead_first );
+        this->_MyRead_last -= this->_MyRead_first;
+        this->_MyRead_first = 0;
+        }
+
+    _NODISCARD inline bool _Take_raw( void* _Dest, size_t _ByteSize ) noexcept
+        {   // consume raw bytes from the read buffer, false if not enough data has been received
+        if( this->_MyRead_last - this->_MyRead_first < _ByteSize )
+            return false;
+        __impl::memcpy( _Dest, _Read_data() + this->_MyRead_first, _ByteSize );
+        this->_MyRead_first += _ByteSize;
+        return true;
+        }
+
+    _NODISCARD inline bool _Find_string( const _Elem*& _First, size_t& _Length, size_t _Maxlen, size_t& _Scanned )
+        {   // find terminated string in the read buffer, false if the terminator has not been received
+        // _Scanned holds number of elements already searched, so that no element is scanned
+        // twice while the string is being received.
+        if( (this->_MyRead_first % alignof( _Elem )) != 0 )
+            _Compact_read_buffer();
+        _First = reinterpret_cast<const _Elem*>(_Read_data() + this->_MyRead_first);
+        const size_t _Count = (this->_MyRead_last - this->_MyRead_first) / sizeof( _Elem );
+        const _Elem* const _End = _Traits::find( _First + _Scanned, _Count - _Scanned, _Elem() );
+        if( _End == nullptr )
+            {
+            _Scanned = _Count;
+            if( _Count >= _Maxlen )
+                throw std::runtime_error( "insufficient buffer for string" );
+            return false;
+            }
+        _Length = static_cast<size_t>(_End - _First);
+        if( _Length + 1 > _Maxlen )
             throw std::runtime_error( "insufficient buffer for string" );
+        return true;
+        }
+
+    _NODISCARD inline bool _Take_string( std::basic_string<_Elem, _Traits>& _Str, size_t _Maxlen, size_t& _Scanned )
+        {   // consume terminated string from the read buffer, false if the terminator has not been received
+        const _Elem* _First;
+        size_t _Length;
+        if( !_Find_string( _First, _Length, _Maxlen, _Scanned ) )
+            return false;
+        _Str.assign( _First, _Length );
+        this->_MyRead_first += (_Length + 1) * sizeof( _Elem );
+        return true;
+        }
+
+    inline void _Read( void* _Dest, size_t _ByteSize )
+        {   // receive raw bytes through the read buffer
+        while( !_Take_raw( _Dest, _ByteSize ) )
+            _Fill_read_buffer_or_throw();
+        }
+
+    static constexpr size_t _Max_length_size = 10; // varint encoding of 64-bit length
+
+    _NODISCARD inline bool _Is_framed() const noexcept
+        {   // check if strings and vectors are prefixed with length
+        return (this->_MyMode & basic_socketstream::framed) == basic_socketstream::framed;
+        }
+
+    inline void _Throw_if_not_framed()
+        {   // throw an exception if the stream is not in framed mode
+        if( !_Is_framed() )
+            {
+            throw std::runtime_error( "operation requires framed stream" );
+            }
+        }
+
+    _NODISCARD static inline size_t _Encode_length( unsigned char* _Dest, std::uint64_t _Length ) noexcept
+        {   // encode length as varint (7 bits per byte, least significant first)
+        size_t _Size = 0;
+        while( _Length >= 0x80 )
+            {
+            _Dest[_Size++] = static_cast<unsigned char>(_Length | 0x80);
+            _Length >>= 7;
+            }
+        _Dest[_Size++] = static_cast<unsigned char>(_Length);
+        return _Size;
+        }
+
+    _NODISCARD inline std::vector<char> _Make_frame( const void* _Data, size_t _Count, size_t _Elem_size ) const
+        {   // build frame with length prefix and payload
+        unsigned char _Prefix[_Max_length_size];
+        const size_t _Prefix_size = _Encode_length( _Prefix, _Count );
+        std::vector<char> _Frame( _Prefix_size + _Count * _Elem_size );
+        __impl::memcpy( _Frame.data(), _Prefix, _Prefix_size );
+        if( _Count != 0 )
+            __impl::memcpy( _Frame.data() + _Prefix_size, _Data, _Count * _Elem_size );
+        return _Frame;
+        }
+
+    inline basic_socketstream& _Write_framed( const void* _Data, size_t _Count, size_t _Elem_size )
+        {   // send length prefix and payload without terminator
+        unsigned char _Prefix[_Max_length_size];
+        const size_t _Prefix_size = _Encode_length( _Prefix, _Count );
+        if( this->_MyWrite_limit == 0 )
+            { // prefix and payload are sent in a single call, so they share the segment
+            socket_buffer _Buffers[2] = {
+                socket_buffer( _Prefix, _Prefix_size ),
+                socket_buffer( _Data, _Count * _Elem_size ) };
+            _Send_all( _Buffers, 2, this->_MyCork );
+            if( (flags() & _MyBase::unitbuf) != 0 )
+                flush();
+            }
+        else
+            {
+            _Write( _Prefix, _Prefix_size );
+            _Write( _Data, _Count * _Elem_size );
+            }
+        return (*this);
+        }
+
+    _NODISCARD inline bool _Take_length( size_t& _Length )
+        {   // consume varint length prefix from the read buffer, false if not enough data has been received
+        const unsigned char* const _First =
+            reinterpret_cast<const unsigned char*>(_Read_data() + this->_MyRead_first);
+        const size_t _Available = __impl::min( this->_MyRead_last - this->_MyRead_first, static_cast<size_t>(_Max_length_size) );
+        std::uint64_t _Value = 0;
+        for( size_t i = 0; i < _Available; ++i )
+            {
+            if( i == _Max_length_size - 1 && _First[i] > 1 )
+                throw std::runtime_error( "invalid length prefix" );
+            _Value |= static_cast<std::uint64_t>(_First[i] & 0x7f) << (7 * i);
+            if( (_First[i] & 0x80) == 0 )
+                {
+                if( _Value > std::numeric_limits<size_t>::max() )
+                    throw std::runtime_error( "invalid length prefix" );
+                _Length = static_cast<size_t>(_Value);
+                this->_MyRead_first += i + 1;
+                return true;
+                }
+            }
+        if( _Available == _Max_length_size )
+            throw std::runtime_error( "invalid length prefix" );
+        return false;
+        }
+
+    inline size_t _Read_length( size_t _Elem_size )
+        {   // receive length prefix of the frame
+        size_t _Length;
+        while( !_Take_length( _Length ) )
+            _Fill_read_buffer_or_throw();
+        if( _Length > std::numeric_limits<size_t>::max() / _Elem_size )
+            throw std::runtime_error( "invalid length prefix" );
+        return _Length;
+        }
+
+    _NODISCARD inline size_t _Take_some( void* _Dest, size_t _ByteSize ) noexcept
+        {   // consume up to _ByteSize bytes from the read buffer
+        const size_t _Count = __impl::min( this->_MyRead_last - this->_MyRead_first, _ByteSize );
+        if( _Count != 0 )
+            __impl::memcpy( _Dest, _Read_data() + this->_MyRead_first, _Count );
+        this->_MyRead_first += _Count;
+        return _Count;
+        }
+
+    inline void _Read_direct( void* _Dest, size_t _ByteSize )
+        {   // receive payload of known size, large payloads bypass the read buffer
+        char* const _Bytes = static_cast<char*>(_Dest);
+        size_t _Received = _Take_some( _Bytes, _ByteSize );
+        if( _ByteSize - _Received < _Read_chunk )
+            {
+            _Read( _Bytes + _Received, _ByteSize - _Received );
+            return;
+            }
+        while( _Received < _ByteSize )
+            {
+            const size_t _Size = __impl::min( _ByteSize - _Received,
+                static_cast<size_t>(std::numeric_limits<int>::max()) );
+            const int _Retval = this->_MySocket->recv( _Bytes + _Received, _Size, socket_recv_flags::wait_all );
+            if( _Retval == 0 )
+                throw socket_exception( ECONNRESET ); // closed before whole value has been received
+            _Received += static_cast<size_t>(_Retval);
+            }
+        }
+
+    template<typename _Ty>
+    inline basic_socketstream& _Common_send_arithmetic( const _Ty& _Val,
+            typename std::enable_if<std::is_arithmetic<_Ty>::value>::type* = nullptr )
+        {   // serialize arithmetic value
+        _Throw_if_uninitialized();
+        if( (this->_MyMode & basic_socketstream::binary) == basic_socketstream::binary )
+            { // binary serialization, send raw bytes
+            _Write( &_Val, sizeof( _Ty ) );
+            }
+        else
+            { // text serialization, send string representation with terminator
+            _Elem _Text[_Format_buffer_size + 1];
+            const size_t _Length = _Format_arithmetic( _Text, _Val );
+            if( _Length != 0 )
+                _Write( _Text, (_Length + 1) * sizeof( _Elem ) );
+            else
+                {
+                std::basic_string<_Elem, _Traits> _Val_str = (_Create_stringstream() << _Val).str();
+                _Write( _Val_str.c_str(), (_Val_str.length() + 1) * sizeof( _Elem ) );
+                }
+            }
+        return (*this);
+        }
+
+    template<typename _Ty>
+    inline basic_socketstream& _Common_recv_arithmetic( _Ty& _Val,
+            typename std::enable_if<std::is_arithmetic<_Ty>::value>::type* = nullptr )
+        {   // deserialize arithmetic value
+        _Throw_if_uninitialized();
+        if( (this->_MyMode & basic_socketstream::binary) == basic_socketstream::binary )
+            { // binary deserialization, recv raw bytes
+            _Read( &_Val, sizeof( _Ty ) );
+            }
+        else
+            { // text deserialization, parse string representation in the read buffer
+            const _Elem* _First;
+            size_t _Length;
+            size_t _Scanned = 0;
+            while( !_Find_string( _First, _Length, std::numeric_limits<size_t>::max(), _Scanned ) )
+                _Fill_read_buffer_or_throw();
+            _Parse_arithmetic( _First, _Length, _Val );
+            this->_MyRead_first += (_Length + 1) * sizeof( _Elem );
+            }
+        return (*this);
+        }
+
+    static constexpr size_t _Format_buffer_size = 128;
+
+    template<typename _Ty>
+    _NODISCARD inline std::basic_string<_Elem, _Traits> _To_text( const _Ty& _Val )
+        {   // get string representation of arithmetic value
+        _Elem _Text[_Format_buffer_size + 1];
+        const size_t _Length = _Format_arithmetic( _Text, _Val );
+        if( _Length != 0 )
+            return std::basic_string<_Elem, _Traits>( _Text, _Length );
+        return (_Create_stringstream() << _Val).str();
+        }
+
+#if defined( _LIBSOCK_HAS_TO_CHARS )
+    template<typename _Ty>
+    inline size_t _Format_arithmetic( _Elem (&_Text)[_Format_buffer_size + 1], const _Ty& _Val,
+            typename std::enable_if<std::is_integral<_Ty>::value && _Is_charconv_number<_Ty>::value>::type* = nullptr )
+        {   // format integer without allocations, honors basefield, showbase, showpos and uppercase
+        // Like in the standard streams, negative values are formatted as unsigned in hex and oct.
+        const int _Fmtfl = static_cast<int>(flags());
+        const int _Basefield = _Fmtfl & _MyBase::basefield;
+        const int _Base = (_Basefield == _MyBase::hex) ? 16 : (_Basefield == _MyBase::oct) ? 8 : 10;
+        char _Chars[_Format_buffer_size];
+        char* _Next = _Chars;
+        std::to_chars_result _Result;
+        if( _Base == 10 )
+            {
+            if( (_Fmtfl & _MyBase::showpos) != 0 && std::is_signed<_Ty>::value && _Val >= 0 )
+                *_Next++ = '+';
+            _Result = std::to_chars( _Next, _Chars + _Format_buffer_size, _Val );
+            }
+        else
+            {
+            typedef typename std::make_unsigned<_Ty>::type _Uty;
+            if( (_Fmtfl & _MyBase::showbase) != 0 && _Val != 0 )
+                { // same prefixes as printf with '#' flag
+                *_Next++ = '0';
+                if( _Base == 16 )
+                    *_Next++ = 'x';
+                }
+            _Result = std::to_chars( _Next, _Chars + _Format_buffer_size, static_cast<_Uty>(_Val), _Base );
+            }
+        if( _Result.ec != std::errc() )
+            return 0;
+        return _Widen_formatted( _Text, _Chars, _Result.ptr, (_Fmtfl & _MyBase::uppercase) != 0 );
+        }
+
+    template<typename _Ty>
+    inline size_t _Format_arithmetic( _Elem (&_Text)[_Format_buffer_size + 1], const _Ty& _Val,
+            typename std::enable_if<std::is_floating_point<_Ty>::value>::type* = nullptr )
+        {   // format floating-point value without allocations, honors floatfield, precision, showpos and uppercase
+        const int _Fmtfl = static_cast<int>(flags());
+        if( (_Fmtfl & _MyBase::showpoint) != 0 )
+            return 0; // trailing zeros are kept by the stringstream
+        const int _Floatfield = _Fmtfl & _MyBase::floatfield;
+        const int _Precision = (precision() < 0) ? 6 : static_cast<int>(precision());
+        char _Chars[_Format_buffer_size];
+        char* _Next = _Chars;
+        if( (_Fmtfl & _MyBase::showpos) != 0 && !std::signbit( _Val ) )
+            *_Next++ = '+';
+        char* const _Last = _Chars + _Format_buffer_size;
+        std::to_chars_result _Result;
+        if( _Floatfield == _MyBase::fixed )
+            _Result = std::to_chars( _Next, _Last, _Val, std::chars_format::fixed, _Precision );
+        else if( _Floatfield == _MyBase::scientific )
+            _Result = std::to_chars( _Next, _Last, _Val, std::chars_format::scientific, _Precision );
+        else if( _Floatfield == _MyBase::floatfield )
+            { // hexfloat
+            if( std::signbit( _Val ) )
+                *_Next++ = '-';
+            *_Next++ = '0';
+            *_Next++ = 'x';
+            _Result = std::to_chars( _Next, _Last, std::fabs( _Val ), std::chars_format::hex );
+            }
+        else
+            _Result = std::to_chars( _Next, _Last, _Val, std::chars_format::general, _Precision );
+        if( _Result.ec != std::errc() )
+            return 0; // fall back to the stringstream
+        return _Widen_formatted( _Text, _Chars, _Result.ptr, (_Fmtfl & _MyBase::uppercase) != 0 );
+        }
+
+    template<typename _Ty>
+    inline size_t _Format_arithmetic( _Elem (&)[_Format_buffer_size + 1], const _Ty&,
+            typename std::enable_if<!_Is_charconv_number<_Ty>::value>::type* = nullptr )
+        {   // bool and characters are formatted by the stringstream
+        return 0;
+        }
+
+    static inline size_t _Widen_formatted( _Elem (&_Text)[_Format_buffer_size + 1],
+            const char* _First, const char* _Last, bool _Uppercase ) noexcept
+        {   // copy formatted characters to the stream characters, add terminator
+        size_t _Length = 0;
+        for( ; _First != _Last; ++_First, ++_Length )
+            {
+            char _Ch = *_First;
+            if( _Uppercase && _Ch >= 'a' && _Ch <= 'z' )
+                _Ch = static_cast<char>(_Ch - 'a' + 'A');
+            _Text[_Length] = static_cast<_Elem>(_Ch);
+            }
+        _Text[_Length] = _Elem();
+        return _Length;
+        }
+
+    template<typename _Ty>
+    inline void _Parse_arithmetic( const _Elem* _First, size_t _Length, _Ty& _Val,
+            typename std::enable_if<!_Is_charconv_number<_Ty>::value>::type* = nullptr )
+        {   // parse bool or character with the stringstream
+        _Val = _Ty();
+        _Create_stringstream( std::basic_string<_Elem, _Traits>( _First, _Length ) ) >> _Val;
+        }
+
+    template<typename _Ty>
+    inline void _Parse_arithmetic( const _Elem* _First, size_t _Length, _Ty& _Val,
+            typename std::enable_if<_Is_charconv_number<_Ty>::value>::type* = nullptr )
+        {   // parse value without allocations, the value is zero if the text is not valid
+        _Val = _Ty();
+        char _Chars[_Format_buffer_size];
+        if( _Length > _Format_buffer_size )
+            return;
+        for( size_t i = 0; i < _Length; ++i )
+            { // characters of numbers are in the basic character set
+            if( _First[i] <= _Elem() || _First[i] > static_cast<_Elem>(0x7f) )
+                return;
+            _Chars[i] = static_cast<char>(_First[i]);
+            }
+        const char* _Next = _Chars;
+        const char* const _Last = _Chars + _Length;
+        if( _Next != _Last && *_Next == '+' )
+            ++_Next;
+        _Parse_number( _Next, _Last, _Val );
+        }
+
+    template<typename _Ty>
+    inline void _Parse_number( const char* _Next, const char* _Last, _Ty& _Val,
+            typename std::enable_if<std::is_integral<_Ty>::value>::type* = nullptr )
+        {   // parse integer in the base selected by basefield, prefixes are optional
+        const int _Basefield = static_cast<int>(flags()) & _MyBase::basefield;
+        int _Base = (_Basefield == _MyBase::hex) ? 16 : (_Basefield == _MyBase::oct) ? 8 : (_Basefield == _MyBase::dec) ? 10 : 0;
+        const bool _Has_hex_prefix = (_Last - _Next) > 2 && _Next[0] == '0' && (_Next[1] == 'x' || _Next[1] == 'X');
+        if( _Base == 0 )
+            { // detect base like strtol
+            _Base = _Has_hex_prefix ? 16 : ((_Last - _Next) > 1 && _Next[0] == '0') ? 8 : 10;
+            }
+        if( _Base == 16 && _Has_hex_prefix )
+            _Next += 2;
+        std::from_chars_result _Result;
+        _Ty _Parsed;
+        if( _Base == 10 || (_Next != _Last && *_Next == '-') )
+            _Result = std::from_chars( _Next, _Last, _Parsed, _Base );
+        else
+            { // values are sent as unsigned in hex and oct
+            typename std::make_unsigned<_Ty>::type _Unsigned;
+            _Result = std::from_chars( _Next, _Last, _Unsigned, _Base );
+            _Parsed = static_cast<_Ty>(_Unsigned);
+            }
+        if( _Result.ec == std::errc() && _Result.ptr == _Last )
+            _Val = _Parsed;
+        }
+
+    template<typename _Ty>
+    inline void _Parse_number( const char* _Next, const char* _Last, _Ty& _Val,
+            typename std::enable_if<std::is_floating_point<_Ty>::value>::type* = nullptr )
+        {   // parse floating-point value in any format, hexfloat requires the 0x prefix
+        const bool _Negative = (_Next != _Last && *_Next == '-');
+        const char* _Digits = _Negative ? _Next + 1 : _Next;
+        std::chars_format _Format = std::chars_format::general;
+        if( (_Last - _Digits) > 2 && _Digits[0] == '0' && (_Digits[1] == 'x' || _Digits[1] == 'X') )
+            {
+            _Format = std::chars_format::hex;
+            _Digits += 2;
+            _Next = _Digits;
+            }
+        _Ty _Parsed;
+        const std::from_chars_result _Result = std::from_chars( _Next, _Last, _Parsed, _Format );
+        if( _Result.ec == std::errc() && _Result.ptr == _Last )
+            _Val = (_Format == std::chars_format::hex && _Negative) ? -_Parsed : _Parsed;
+        }
+#else
+    template<typename _Ty>
+    inline size_t _Format_arithmetic( _Elem (&)[_Format_buffer_size + 1], const _Ty& )
+        {   // to_chars is not available, use the stringstream
+        return 0;
+        }
+
+    template<typename _Ty>
+    inline void _Parse_arithmetic( const _Elem* _First, size_t _Length, _Ty& _Val )
+        {   // parse value with the stringstream
+        _Create_stringstream( std::basic_string<_Elem, _Traits>( _First, _Length ) ) >> _Val;
+        }
+#endif
+
+    inline basic_socketstream& _Common_recv_string( std::basic_string<_Elem, _Traits>& _Str,
+            size_t _Maxlen = std::numeric_limits<size_t>::max() )
+        {   // receive string value
+        _Throw_if_uninitialized();
+        if( _Is_framed() )
+            { // length is known, receive payload at once
+            const size_t _Length = _Read_length( sizeof( _Elem ) );
+            if( _Length >= _Maxlen )
+                throw std::runtime_error( "insufficient buffer for string" );
+            _Str.resize( _Length );
+            _Read_direct( &_Str[0], _Length * sizeof( _Elem ) );
+            return (*this);
             }
-        // remove whole string from the queue
-        this->_MySocket->recv( _Str_buffer.data(), _Str_buffer.size() * sizeof( _Elem ) );
-        _Str.assign( _Str_buffer.data() );
+        size_t _Scanned = 0;
+        while( !_Take_string( _Str, _Maxlen, _Scanned ) )
+            _Fill_read_buffer_or_throw();
         return (*this);
         }
 
@@ -1889,6 +4580,3153 @@ inline void swap( basic_socketstream<_Elem, _Traits>& _Left, basic_socketstream<
     }
 
 
+// CLASS TEMPLATE basic_socketbuf
+template<typename _Elem, typename _Traits = std::char_traits<_Elem>>
+class basic_socketbuf
+    : public std::basic_streambuf<_Elem, _Traits>
+    {   // stream buffer transferring characters through a stream socket
+public:
+    typedef std::basic_streambuf<_Elem, _Traits> _MyBase;
+    typedef typename _MyBase::char_type char_type;
+    typedef typename _MyBase::traits_type traits_type;
+    typedef typename _MyBase::int_type int_type;
+
+    static constexpr size_t default_buffer_size = 4096;
+
+    basic_socketbuf( const basic_socketbuf& ) = delete;
+    basic_socketbuf& operator=( const basic_socketbuf& ) = delete;
+
+    inline basic_socketbuf() noexcept
+        : _MyBase()
+        , _MySocket( nullptr )
+        , _MyGet_area()
+        , _MyPut_area()
+        , _MyPartial( 0 )
+        {   // construct stream buffer not associated with any socket
+        }
+
+    inline explicit basic_socketbuf( socket& _Socket,
+            size_t _Get_size = basic_socketbuf::default_buffer_size,
+            size_t _Put_size = basic_socketbuf::default_buffer_size )
+        : _MyBase()
+        , _MySocket( &_Socket )
+        , _MyGet_area()
+        , _MyPut_area()
+        , _MyPartial( 0 )
+        {   // construct stream buffer, put area of size 0 sends each character immediately
+        if( !this->_MySocket->_Is_stream_socket() )
+            {
+            throw std::invalid_argument( "cannot create stream buffer from non-stream socket" );
+            }
+        set_get_area_size( _Get_size );
+        set_put_area_size( _Put_size );
+        }
+
+    inline virtual ~basic_socketbuf() noexcept
+        {   // send buffered characters, errors are ignored
+        try
+            {
+            if( this->_MySocket != nullptr )
+                (void)_Flush();
+            }
+        catch( ... )
+            {
+            }
+        }
+
+    _NODISCARD inline socket* get_socket() const noexcept
+        {   // get associated socket
+        return this->_MySocket;
+        }
+
+    inline void set_get_area_size( size_t _Size )
+        {   // set number of characters received at once, received characters are preserved
+        _LIBSOCK_CHECK_ARG_NOT_EQ( _Size, 0 );
+        const size_t _Available = static_cast<size_t>(this->egptr() - this->gptr());
+        if( _Available + (this->_MyPartial != 0 ? 1 : 0) > _Size )
+            throw std::invalid_argument( "get area cannot hold received characters" );
+        // keep incomplete character received after the get area
+        char _Partial[sizeof( _Elem )];
+        if( this->_MyPartial != 0 )
+            __impl::memcpy( _Partial, reinterpret_cast<const char*>(this->egptr()), this->_MyPartial );
+        std::vector<_Elem> _Area( _Size );
+        if( _Available != 0 )
+            traits_type::copy( _Area.data(), this->gptr(), _Available );
+        this->_MyGet_area.swap( _Area );
+        if( this->_MyPartial != 0 )
+            __impl::memcpy( reinterpret_cast<char*>(this->_MyGet_area.data() + _Available), _Partial, this->_MyPartial );
+        _Elem* const _First = this->_MyGet_area.data();
+        this->setg( _First, _First, _First + _Available );
+        }
+
+    inline void set_put_area_size( size_t _Size )
+        {   // set number of characters buffered before sending, 0 disables buffering
+        if( _Flush() != 0 )
+            throw std::runtime_error( "could not send buffered characters" );
+        this->_MyPut_area.resize( _Size );
+        _Elem* const _First = this->_MyPut_area.data();
+        this->setp( _First, _First + _Size );
+        }
+
+    _NODISCARD inline size_t get_area_size() const noexcept
+        {   // get number of characters received at once
+        return this->_MyGet_area.size();
+        }
+
+    _NODISCARD inline size_t put_area_size() const noexcept
+        {   // get number of characters buffered before sending
+        return this->_MyPut_area.size();
+        }
+
+protected:
+    socket* _MySocket;
+    std::vector<_Elem> _MyGet_area;
+    std::vector<_Elem> _MyPut_area;
+    size_t _MyPartial;  // bytes of incomplete character received after the get area
+
+    inline virtual int_type overflow( int_type _Meta = traits_type::eof() ) override
+        {   // send buffered characters, then buffer or send _Meta
+        if( _Flush() != 0 )
+            return traits_type::eof();
+        if( traits_type::eq_int_type( _Meta, traits_type::eof() ) )
+            return traits_type::not_eof( _Meta );
+        const _Elem _Ch = traits_type::to_char_type( _Meta );
+        if( this->pptr() != this->epptr() )
+            { // buffered mode
+            *this->pptr() = _Ch;
+            this->pbump( 1 );
+            }
+        else _Send_all( &_Ch, 1 );
+        return _Meta;
+        }
+
+    inline virtual std::streamsize xsputn( const _Elem* _Ptr, std::streamsize _Count ) override
+        {   // buffer characters, send large blocks directly
+        if( static_cast<size_t>(_Count) < this->_MyPut_area.size() )
+            return _MyBase::xsputn( _Ptr, _Count );
+        if( _Flush() != 0 )
+            return 0;
+        _Send_all( _Ptr, static_cast<size_t>(_Count) );
+        return _Count;
+        }
+
+    inline virtual int sync() override
+        {   // send buffered characters
+        return _Flush();
+        }
+
+    inline virtual int_type underflow() override
+        {   // receive characters into the get area
+        if( this->gptr() != this->egptr() )
+            return traits_type::to_int_type( *this->gptr() );
+        if( this->_MySocket == nullptr )
+            return traits_type::eof();
+        _Elem* const _First = this->_MyGet_area.data();
+        char* const _Bytes = reinterpret_cast<char*>(_First);
+        // move incomplete character to the beginning of the area
+        __impl::memmove( _Bytes, reinterpret_cast<const char*>(this->egptr()), this->_MyPartial );
+        this->setg( _First, _First, _First );
+        size_t _Received = this->_MyPartial;
+        while( _Received < sizeof( _Elem ) )
+            {
+            const size_t _Size = __impl::min( this->_MyGet_area.size() * sizeof( _Elem ) - _Received,
+                static_cast<size_t>(std::numeric_limits<int>::max()) );
+            const int _Retval = this->_MySocket->recv( _Bytes + _Received, _Size );
+            if( _Retval == 0 )
+                return traits_type::eof(); // connection closed
+            _Received += static_cast<size_t>(_Retval);
+            }
+        const size_t _Count = _Received / sizeof( _Elem );
+        this->_MyPartial = _Received % sizeof( _Elem );
+        this->setg( _First, _First, _First + _Count );
+        return traits_type::to_int_type( *_First );
+        }
+
+    inline virtual std::streamsize xsgetn( _Elem* _Ptr, std::streamsize _Count ) override
+        {   // copy received characters, receive large blocks directly
+        const size_t _Available = static_cast<size_t>(this->egptr() - this->gptr());
+        if( static_cast<size_t>(_Count) <= _Available
+            || static_cast<size_t>(_Count) - _Available < this->_MyGet_area.size()
+            || this->_MyPartial != 0 )
+            return _MyBase::xsgetn( _Ptr, _Count );
+        if( _Available != 0 )
+            traits_type::copy( _Ptr, this->gptr(), _Available );
+        this->gbump( static_cast<int>(_Available) );
+        char* const _Bytes = reinterpret_cast<char*>(_Ptr + _Available);
+        const size_t _Size = (static_cast<size_t>(_Count) - _Available) * sizeof( _Elem );
+        size_t _Received = 0;
+        while( _Received < _Size )
+            {
+            const int _Retval = this->_MySocket->recv( _Bytes + _Received,
+                __impl::min( _Size - _Received, static_cast<size_t>(std::numeric_limits<int>::max()) ),
+                socket_recv_flags::wait_all );
+            if( _Retval == 0 )
+                break; // connection closed
+            _Received += static_cast<size_t>(_Retval);
+            }
+        // keep incomplete character received before the connection was closed
+        this->_MyPartial = _Received % sizeof( _Elem );
+        __impl::memcpy( reinterpret_cast<char*>(this->_MyGet_area.data()), _Bytes + (_Received - this->_MyPartial), this->_MyPartial );
+        _Elem* const _First = this->_MyGet_area.data();
+        this->setg( _First, _First, _First );
+        return static_cast<std::streamsize>(_Available + _Received / sizeof( _Elem ));
+        }
+
+    inline int _Flush()
+        {   // send characters from the put area
+        if( this->pbase() == this->pptr() )
+            return 0;
+        if( this->_MySocket == nullptr )
+            return -1;
+        const size_t _Count = static_cast<size_t>(this->pptr() - this->pbase());
+        _Elem* const _First = this->_MyPut_area.data();
+        this->setp( _First, _First + this->_MyPut_area.size() );
+        _Send_all( _First, _Count );
+        return 0;
+        }
+
+    inline void _Send_all( const _Elem* _Ptr, size_t _Count )
+        {   // send whole block of characters
+        const char* const _Bytes = reinterpret_cast<const char*>(_Ptr);
+        const size_t _Size = _Count * sizeof( _Elem );
+        size_t _Sent = 0;
+        while( _Sent < _Size )
+            _Sent += static_cast<size_t>(this->_MySocket->send( _Bytes + _Sent, _Size - _Sent ));
+        }
+    };
+
+using socketbuf = basic_socketbuf<char>;
+using wsocketbuf = basic_socketbuf<wchar_t>;
+
+
+// CLASS TEMPLATE basic_socket_iostream
+template<typename _Elem, typename _Traits = std::char_traits<_Elem>>
+class basic_socket_iostream
+    : public std::basic_iostream<_Elem, _Traits>
+    {   // standard iostream formatting over a stream socket
+public:
+    typedef std::basic_iostream<_Elem, _Traits> _MyBase;
+
+    inline explicit basic_socket_iostream( socket& _Socket,
+            size_t _Get_size = basic_socketbuf<_Elem, _Traits>::default_buffer_size,
+            size_t _Put_size = basic_socketbuf<_Elem, _Traits>::default_buffer_size )
+        : _MyBase( nullptr )
+        , _MyBuffer( _Socket, _Get_size, _Put_size )
+        {   // construct stream over the socket
+        this->init( &this->_MyBuffer );
+        }
+
+    _NODISCARD inline basic_socketbuf<_Elem, _Traits>* rdbuf() const noexcept
+        {   // get stream buffer
+        return const_cast<basic_socketbuf<_Elem, _Traits>*>(&this->_MyBuffer);
+        }
+
+protected:
+    basic_socketbuf<_Elem, _Traits> _MyBuffer;
+    };
+
+using socket_iostream = basic_socket_iostream<char>;
+using wsocket_iostream = basic_socket_iostream<wchar_t>;
+
+
+class socket_ring_buffer;
+
+// CLASS socket_view
+class socket_view
+    {   // received bytes owned by socket_ring_buffer, valid until released
+public:
+    inline socket_view() noexcept
+        : _MyData( nullptr ), _MySize( 0 ), _MyEnd( 0 )
+        {   // construct empty view
+        }
+
+    _NODISCARD inline const char* data() const noexcept
+        {   // get pointer to the first byte
+        return this->_MyData;
+        }
+
+    _NODISCARD inline size_t size() const noexcept
+        {   // get number of bytes
+        return this->_MySize;
+        }
+
+    _NODISCARD inline bool empty() const noexcept
+        {   // check if the view is empty
+        return this->_MySize == 0;
+        }
+
+#if defined( __cpp_lib_string_view )
+    _NODISCARD inline std::string_view str() const noexcept
+        {   // get bytes as string view
+        return std::string_view( this->_MyData, this->_MySize );
+        }
+
+    _NODISCARD inline operator std::string_view() const noexcept
+        {   // get bytes as string view
+        return str();
+        }
+#endif
+
+#if defined( __cpp_lib_span )
+    _NODISCARD inline std::span<const char> span() const noexcept
+        {   // get bytes as span
+        return std::span<const char>( this->_MyData, this->_MySize );
+        }
+#endif
+
+protected:
+    friend class socket_ring_buffer;
+
+    const char* _MyData;
+    size_t _MySize;
+    std::uint64_t _MyEnd;   // position in the ring buffer following the view
+    };
+
+
+// CLASS socket_ring_buffer
+class socket_ring_buffer
+    {   // circular buffer of received or queued data, hands out views without copying
+    // Data is consumed with read/read_until in the order it has been received. Space taken
+    // by consumed data is reused only once the views are released.
+    // In mirrored mode (Linux) the buffer is mapped twice back to back, so any readable
+    // or writable region is contiguous. Otherwise views spanning the end of the buffer
+    // are copied into a spill buffer, only one such view exists at a time.
+public:
+    static constexpr size_t default_capacity = 64 * 1024;
+    static constexpr size_t max_capacity = (std::numeric_limits<size_t>::max() >> 2) + 1;
+    static constexpr int linear = 0;
+    static constexpr int mirrored = 1;
+
+    socket_ring_buffer( const socket_ring_buffer& ) = delete;
+    socket_ring_buffer& operator=( const socket_ring_buffer& ) = delete;
+
+#if defined( OS_LINUX )
+    inline explicit socket_ring_buffer( size_t _Capacity = socket_ring_buffer::default_capacity,
+            int _Mode = socket_ring_buffer::mirrored )
+#else
+    inline explicit socket_ring_buffer( size_t _Capacity = socket_ring_buffer::default_capacity,
+            int _Mode = socket_ring_buffer::linear )
+#endif
+        : _MyBuffer()
+        , _MyData( nullptr )
+        , _MyCapacity( 0 )
+        , _MyReleased( 0 )
+        , _MyRead( 0 )
+        , _MyWritten( 0 )
+        , _MySpill()
+        {   // construct buffer, capacity is rounded up to the power of two (page size if mirrored)
+        // Falls back to linear mode if the memory cannot be mapped twice.
+        _LIBSOCK_CHECK_ARG_NOT_EQ( _Capacity, 0 );
+        _LIBSOCK_CHECK_ARG_NOT_GREATER( _Capacity, socket_ring_buffer::max_capacity );
+#if defined( OS_LINUX )
+        if( _Mode == socket_ring_buffer::mirrored )
+            {
+            try
+                {
+                _Mirrored_memory( _Mirrored_memory::_Round_size( _Capacity ) )._Swap( this->_MyMirror );
+                this->_MyData = this->_MyMirror._Data();
+                this->_MyCapacity = this->_MyMirror._Size();
+                return;
+                }
+            catch( const socket_exception& )
+                {
+                }
+            }
+#else
+        (void)_Mode;
+#endif
+        this->_MyCapacity = 1;
+        while( this->_MyCapacity < _Capacity )
+            this->_MyCapacity <<= 1;
+        this->_MyBuffer.reset( new char[this->_MyCapacity] );
+        this->_MyData = this->_MyBuffer.get();
+        }
+
+    _NODISCARD inline size_t capacity() const noexcept
+        {   // get size of the buffer
+        return this->_MyCapacity;
+        }
+
+    _NODISCARD inline bool is_mirrored() const noexcept
+        {   // check if the buffer is mapped twice
+        return this->_MyBuffer == nullptr;
+        }
+
+    _NODISCARD inline size_t size() const noexcept
+        {   // get number of received bytes which have not been read yet
+        return static_cast<size_t>(this->_MyWritten - this->_MyRead);
+        }
+
+    _NODISCARD inline size_t free_space() const noexcept
+        {   // get number of bytes which can be received before views are released
+        return this->_MyCapacity - static_cast<size_t>(this->_MyWritten - this->_MyReleased);
+        }
+
+    inline int recv( socket& _Socket, _Socket_recv_flags_helper _Flags = socket_recv_flags::none )
+        {   // receive data into free space, 0 if the connection has been closed
+        const socket_result<int> _Result = recv( _Socket, std::nothrow, _Flags );
+        _Throw_if_failed_result( _Result );
+        return _Result.value;
+        }
+
+    _NODISCARD inline socket_result<int> recv( socket& _Socket, std::nothrow_t,
+            _Socket_recv_flags_helper _Flags = socket_recv_flags::none ) noexcept
+        {   // receive data into free space, report failures via result
+        socket_result<int> _Result{};
+        const size_t _Free = free_space();
+        if( _Free == 0 )
+            {
+            _Result.error = std::error_code( ENOBUFS, socket_category() );
+            return _Result;
+            }
+        socket_buffer _Buffers[2];
+        const size_t _Count = _Segments( this->_MyWritten, _Free, _Buffers );
+        _Result = _Socket.recv_vec( _Buffers, _Count, std::nothrow, _Flags );
+        if( _Result )
+            this->_MyWritten += static_cast<std::uint64_t>(_Result.value);
+        return _Result;
+        }
+
+    _NODISCARD inline bool read( size_t _Count, socket_view& _View )
+        {   // consume _Count bytes, false if not enough data has been received
+        if( _Count > size() )
+            return false;
+        _View = _Make_view( this->_MyRead, _Count );
+        this->_MyRead += _Count;
+        return true;
+        }
+
+    _NODISCARD inline bool read_until( char _Delim, socket_view& _View )
+        {   // consume bytes up to and including the delimiter, false if it has not been received
+        socket_buffer _Buffers[2];
+        const size_t _Segments_count = _Segments( this->_MyRead, size(), _Buffers );
+        size_t _Count = 0;
+        for( size_t i = 0; i < _Segments_count; ++i )
+            {
+            const char* const _First = reinterpret_cast<const char*>(_Buffers[i].data);
+            const void* const _Found = ::memchr( _First, _Delim, _Buffers[i].size );
+            if( _Found != nullptr )
+                return read( _Count + static_cast<size_t>(static_cast<const char*>(_Found) - _First) + 1, _View );
+            _Count += _Buffers[i].size;
+            }
+        return false;
+        }
+
+    inline void release( const socket_view& _View ) noexcept
+        {   // allow reusing space of the view and all views read before it
+        if( _View._MyEnd > this->_MyReleased && _View._MyEnd <= this->_MyRead )
+            this->_MyReleased = _View._MyEnd;
+        }
+
+    inline void release() noexcept
+        {   // allow reusing space of all views
+        this->_MyReleased = this->_MyRead;
+        }
+
+    _NODISCARD inline char* prepare( size_t _Count ) noexcept
+        {   // get contiguous free space for _Count bytes, nullptr if not available
+        // In linear mode, the space is not contiguous if it wraps around the end of the buffer.
+        if( _Count > free_space() )
+            return nullptr;
+        const size_t _First = _Index( this->_MyWritten );
+        if( !is_mirrored() && _First + _Count > this->_MyCapacity )
+            return nullptr;
+        return this->_MyData + _First;
+        }
+
+    inline void commit( size_t _Count ) noexcept
+        {   // append _Count bytes written into space returned by prepare
+        this->_MyWritten += static_cast<std::uint64_t>(_Count);
+        }
+
+    _NODISCARD inline bool write( const void* _Data, size_t _Count ) noexcept
+        {   // append copy of the data, false if there is not enough free space
+        if( _Count > free_space() )
+            return false;
+        socket_buffer _Buffers[2];
+        const size_t _Segments_count = _Segments( this->_MyWritten, _Count, _Buffers );
+        const char* _Source = static_cast<const char*>(_Data);
+        for( size_t i = 0; i < _Segments_count; ++i )
+            {
+            __impl::memcpy( _Buffers[i].data, _Source, _Buffers[i].size );
+            _Source += _Buffers[i].size;
+            }
+        this->_MyWritten += static_cast<std::uint64_t>(_Count);
+        return true;
+        }
+
+    inline int send( socket& _Socket, _Socket_send_flags_helper _Flags = socket_send_flags::none )
+        {   // send data which has not been read yet, sent data is released
+        const socket_result<int> _Result = send( _Socket, std::nothrow, _Flags );
+        _Throw_if_failed_result( _Result );
+        return _Result.value;
+        }
+
+    _NODISCARD inline socket_result<int> send( socket& _Socket, std::nothrow_t,
+            _Socket_send_flags_helper _Flags = socket_send_flags::none ) noexcept
+        {   // send data which has not been read yet, report failures via result
+        socket_result<int> _Result{};
+        if( size() == 0 )
+            return _Result;
+        socket_buffer _Buffers[2];
+        const size_t _Count = _Segments( this->_MyRead, size(), _Buffers );
+        _Result = _Socket.send_vec( _Buffers, _Count, std::nothrow, _Flags );
+        if( _Result )
+            {
+            this->_MyRead += static_cast<std::uint64_t>(_Result.value);
+            this->_MyReleased = this->_MyRead;
+            }
+        return _Result;
+        }
+
+protected:
+    std::unique_ptr<char[]> _MyBuffer;  // storage in linear mode
+#if defined( OS_LINUX )
+    _Mirrored_memory _MyMirror;         // storage in mirrored mode
+#endif
+    char* _MyData;
+    size_t _MyCapacity;
+    std::uint64_t _MyReleased;  // end of the released data
+    std::uint64_t _MyRead;      // end of the data handed out as views
+    std::uint64_t _MyWritten;   // end of the received data
+    std::vector<char> _MySpill; // copy of the view wrapping around the end of the buffer
+
+    static inline void _Throw_if_failed_result( const socket_result<int>& _Result )
+        {   // throw an exception if the operation failed or would block
+        if( _Result.error )
+            throw socket_exception( _Result.error.value() );
+        if( _Result.would_block )
+            throw socket_exception( EWOULDBLOCK );
+        }
+
+    _NODISCARD inline size_t _Index( std::uint64_t _Position ) const noexcept
+        {   // get offset of the position in the buffer
+        return static_cast<size_t>(_Position & (this->_MyCapacity - 1));
+        }
+
+    inline size_t _Segments( std::uint64_t _Position, size_t _Count, socket_buffer (&_Buffers)[2] ) const noexcept
+        {   // describe _Count bytes starting at the position, the region wraps in linear mode only
+        const size_t _First = _Index( _Position );
+        const size_t _Head = is_mirrored() ? _Count : __impl::min( _Count, this->_MyCapacity - _First );
+        _Buffers[0] = socket_buffer( this->_MyData + _First, _Head );
+        _Buffers[1] = socket_buffer( this->_MyData, _Count - _Head );
+        return (_Count > _Head) ? 2 : 1;
+        }
+
+    inline socket_view _Make_view( std::uint64_t _Position, size_t _Count )
+        {   // construct view of the received data, copy data wrapping around the end
+        socket_view _View;
+        const size_t _First = _Index( _Position );
+        const size_t _Head = this->_MyCapacity - _First;
+        _View._MySize = _Count;
+        _View._MyEnd = _Position + _Count;
+        if( _Count <= _Head || is_mirrored() )
+            _View._MyData = this->_MyData + _First;
+        else
+            { // data of the previous spilled view has been released, since the buffer
+              // cannot hold data wrapping around the end twice
+            this->_MySpill.resize( _Count );
+            __impl::memcpy( this->_MySpill.data(), this->_MyData + _First, _Head );
+            __impl::memcpy( this->_MySpill.data() + _Head, this->_MyData, _Count - _Head );
+            _View._MyData = this->_MySpill.data();
+            }
+        return _View;
+        }
+    };
+
+
+class timer_wheel;
+
+// CLASS socket_timer
+class socket_timer
+    {   // timer scheduled in the timer_wheel, linked directly into the wheel's slot
+public:
+    typedef std::function<void()> handler_type;
+
+    socket_timer( const socket_timer& ) = delete;
+    socket_timer& operator=( const socket_timer& ) = delete;
+
+    inline socket_timer() noexcept
+        : _MyHandler()
+        , _MyWheel( nullptr )
+        , _MyNext( nullptr )
+        , _MyPrev( nullptr )
+        , _MyExpiry( 0 )
+        , _MySlot( _No_slot )
+        {   // construct timer without handler
+        }
+
+    inline explicit socket_timer( handler_type _Handler )
+        : socket_timer()
+        {   // construct timer
+        this->_MyHandler = __impl::move( _Handler );
+        }
+
+    inline socket_timer( socket_timer&& _Original ) noexcept
+        : socket_timer()
+        {   // take over the timer, including its place in the wheel
+        _Take( _Original );
+        }
+
+    inline socket_timer& operator=( socket_timer&& _Original ) noexcept
+        {   // take over the timer, including its place in the wheel
+        if( this != &_Original )
+            {
+            cancel();
+            _Take( _Original );
+            }
+        return (*this);
+        }
+
+    inline ~socket_timer() noexcept
+        {   // destroy timer, removing it from the wheel
+        cancel();
+        }
+
+    inline void set_handler( handler_type _Handler )
+        {   // replace function called on expiry
+        this->_MyHandler = __impl::move( _Handler );
+        }
+
+    _NODISCARD inline bool pending() const noexcept
+        {   // check if the timer is scheduled
+        return this->_MyWheel != nullptr;
+        }
+
+    inline void cancel() noexcept;
+
+protected:
+    static constexpr unsigned int _No_slot = ~0u;
+
+    handler_type _MyHandler;
+    timer_wheel* _MyWheel;
+    socket_timer* _MyNext;
+    socket_timer** _MyPrev; // link pointing to this timer
+    std::uint64_t _MyExpiry;
+    unsigned int _MySlot;
+
+    inline void _Take( socket_timer& _Original ) noexcept
+        {   // move handler and links of the timer
+        this->_MyHandler = __impl::move( _Original._MyHandler );
+        this->_MyWheel = _Original._MyWheel;
+        this->_MyNext = _Original._MyNext;
+        this->_MyPrev = _Original._MyPrev;
+        this->_MyExpiry = _Original._MyExpiry;
+        this->_MySlot = _Original._MySlot;
+        if( this->_MyPrev != nullptr )
+            (*this->_MyPrev) = this;
+        if( this->_MyNext != nullptr )
+            this->_MyNext->_MyPrev = &this->_MyNext;
+        _Original._MyWheel = nullptr;
+        _Original._MyNext = nullptr;
+        _Original._MyPrev = nullptr;
+        _Original._MySlot = _No_slot;
+        }
+
+    friend class timer_wheel;
+    };
+
+
+// CLASS timer_wheel
+class timer_wheel
+    {   // hierarchical timing wheel with constant time scheduling and cancellation
+public:
+    typedef std::chrono::steady_clock clock_type;
+
+    timer_wheel( const timer_wheel& ) = delete;
+    timer_wheel& operator=( const timer_wheel& ) = delete;
+
+    inline explicit timer_wheel( std::chrono::milliseconds _Resolution = std::chrono::milliseconds( 1 ) )
+        : _MyOrigin( clock_type::now() )
+        , _MyResolution( std::chrono::duration_cast<clock_type::duration>(_Resolution) )
+        , _MyTick( 0 )
+        , _MyCount( 0 )
+        , _MySlots()
+        , _MyOccupied()
+        {   // construct empty timer wheel
+        _LIBSOCK_CHECK_ARG_NOT_EQ( _Resolution.count(), 0 );
+        }
+
+    inline ~timer_wheel() noexcept
+        {   // destroy timer wheel, scheduled timers become idle
+        for( socket_timer*& _Head : this->_MySlots )
+            {
+            while( _Head != nullptr )
+                _Unlink( *_Head );
+            }
+        }
+
+    inline void schedule( socket_timer& _Timer, std::chrono::milliseconds _Timeout ) noexcept
+        {   // schedule timer to expire after _Timeout, reschedules pending timer
+        schedule_at( _Timer, clock_type::now() + _Timeout );
+        }
+
+    inline void schedule_at( socket_timer& _Timer, clock_type::time_point _Time ) noexcept
+        {   // schedule timer to expire at _Time, reschedules pending timer
+        _Timer.cancel();
+        const clock_type::duration _Elapsed = _Time - this->_MyOrigin;
+        _Timer._MyExpiry = (_Elapsed.count() <= 0) ? 0
+            : static_cast<std::uint64_t>((_Elapsed.count() + this->_MyResolution.count() - 1)
+                / this->_MyResolution.count());
+        _Timer._MyWheel = this;
+        ++this->_MyCount;
+        _Insert( _Timer );
+        }
+
+    inline void cancel( socket_timer& _Timer ) noexcept
+        {   // remove timer from the wheel
+        if( _Timer._MyWheel == this )
+            _Timer.cancel();
+        }
+
+    _NODISCARD inline size_t size() const noexcept
+        {   // get number of scheduled timers
+        return this->_MyCount;
+        }
+
+    _NODISCARD inline bool empty() const noexcept
+        {   // check if there are no scheduled timers
+        return this->_MyCount == 0;
+        }
+
+    inline size_t advance( clock_type::time_point _Now = clock_type::now() )
+        {   // expire timers due at _Now, returns number of called handlers
+        const clock_type::duration _Elapsed = _Now - this->_MyOrigin;
+        if( _Elapsed.count() < 0 )
+            return 0;
+        const std::uint64_t _Target = static_cast<std::uint64_t>(_Elapsed.count() / this->_MyResolution.count());
+        size_t _Expired = 0;
+        // Ticks without any work (no expiring timers and no occupied slots to cascade)
+        // are skipped, so the cost does not depend on the time elapsed since last call.
+        while( this->_MyCount != 0 )
+            {
+            const std::uint64_t _Tick = _Next_tick();
+            if( _Tick > _Target )
+                break;
+            _Expired += _Process( _Tick );
+            }
+        if( this->_MyTick <= _Target )
+            this->_MyTick = _Target + 1;
+        return _Expired;
+        }
+
+    _NODISCARD inline int next_timeout( clock_type::time_point _Now = clock_type::now() ) const noexcept
+        {   // get milliseconds until the wheel has to be advanced, -1 if there are no timers
+        if( this->_MyCount == 0 )
+            return -1;
+        const clock_type::time_point _Time = this->_MyOrigin
+            + this->_MyResolution * static_cast<clock_type::rep>(_Next_tick());
+        if( _Time <= _Now )
+            return 0;
+        const std::chrono::milliseconds::rep _Ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                _Time - _Now + std::chrono::milliseconds( 1 ) - clock_type::duration( 1 )).count();
+        return static_cast<int>(__impl::min<std::chrono::milliseconds::rep>( _Ms, std::numeric_limits<int>::max() ));
+        }
+
+protected:
+    // Each level divides range of the previous one into 64 slots. Timers are placed
+    // on the level determined by the highest bits in which their expiry tick differs
+    // from the current one, and cascade into lower levels when the current tick
+    // reaches their slot. Timers beyond range of the top level are cascaded
+    // repeatedly until they fit.
+    static constexpr unsigned int _Slot_bits = 6;
+    static constexpr unsigned int _Slots = 1u << _Slot_bits;
+    static constexpr unsigned int _Levels = 4;
+
+    clock_type::time_point _MyOrigin;
+    clock_type::duration _MyResolution;
+    std::uint64_t _MyTick; // first tick which has not been processed yet
+    size_t _MyCount;
+    socket_timer* _MySlots[_Levels * _Slots];
+    std::uint64_t _MyOccupied[_Levels];
+
+    inline void _Insert( socket_timer& _Timer ) noexcept
+        {   // link timer into the slot covering its expiry tick
+        const std::uint64_t _Tick = __impl::max( _Timer._MyExpiry, this->_MyTick );
+        const std::uint64_t _Diff = _Tick ^ this->_MyTick;
+        unsigned int _Level = 0;
+        while( _Level < _Levels - 1 && (_Diff >> (_Slot_bits * (_Level + 1))) != 0 )
+            ++_Level;
+        const unsigned int _Shift = _Slot_bits * _Level;
+        std::uint64_t _Index = _Tick >> _Shift;
+        if( _Level == _Levels - 1 && _Index - (this->_MyTick >> _Shift) >= _Slots )
+            { // out of range, place in the last slot reached before the expiry
+            _Index = (this->_MyTick >> _Shift) + _Slots - 1;
+            }
+        const unsigned int _Slot = _Level * _Slots + static_cast<unsigned int>(_Index & (_Slots - 1));
+        socket_timer*& _Head = this->_MySlots[_Slot];
+        _Timer._MyNext = _Head;
+        _Timer._MyPrev = &_Head;
+        if( _Head != nullptr )
+            _Head->_MyPrev = &_Timer._MyNext;
+        _Head = &_Timer;
+        _Timer._MySlot = _Slot;
+        this->_MyOccupied[_Level] |= std::uint64_t( 1 ) << (_Slot & (_Slots - 1));
+        }
+
+    inline void _Unlink( socket_timer& _Timer ) noexcept
+        {   // remove timer from the list it is linked into
+        (*_Timer._MyPrev) = _Timer._MyNext;
+        if( _Timer._MyNext != nullptr )
+            _Timer._MyNext->_MyPrev = _Timer._MyPrev;
+        if( _Timer._MySlot != socket_timer::_No_slot && this->_MySlots[_Timer._MySlot] == nullptr )
+            this->_MyOccupied[_Timer._MySlot / _Slots] &= ~(std::uint64_t( 1 ) << (_Timer._MySlot & (_Slots - 1)));
+        _Timer._MyWheel = nullptr;
+        _Timer._MyNext = nullptr;
+        _Timer._MyPrev = nullptr;
+        _Timer._MySlot = socket_timer::_No_slot;
+        --this->_MyCount;
+        }
+
+    inline void _Take_slot( unsigned int _Slot, socket_timer*& _List ) noexcept
+        {   // move timers of the slot into the detached list
+        _List = this->_MySlots[_Slot];
+        this->_MySlots[_Slot] = nullptr;
+        this->_MyOccupied[_Slot / _Slots] &= ~(std::uint64_t( 1 ) << (_Slot & (_Slots - 1)));
+        for( socket_timer* _Timer = _List; _Timer != nullptr; _Timer = _Timer->_MyNext )
+            _Timer->_MySlot = socket_timer::_No_slot;
+        if( _List != nullptr )
+            _List->_MyPrev = &_List;
+        }
+
+    inline size_t _Process( std::uint64_t _Tick )
+        {   // cascade higher levels reached at _Tick and expire timers due at _Tick
+        this->_MyTick = _Tick;
+        for( unsigned int _Level = _Levels - 1; _Level > 0; --_Level )
+            {
+            const unsigned int _Shift = _Slot_bits * _Level;
+            if( (_Tick & ((std::uint64_t( 1 ) << _Shift) - 1)) != 0 )
+                continue;
+            socket_timer* _List;
+            _Take_slot( _Level * _Slots + static_cast<unsigned int>((_Tick >> _Shift) & (_Slots - 1)), _List );
+            _Reinsert( _List );
+            }
+        socket_timer* _List;
+        _Take_slot( static_cast<unsigned int>(_Tick & (_Slots - 1)), _List );
+        // timers rescheduled by the handlers are not expired in this pass
+        this->_MyTick = _Tick + 1;
+        size_t _Expired = 0;
+        try
+            {
+            while( _List != nullptr )
+                { // handler may destroy the timer, call a copy of it
+                socket_timer& _Timer = *_List;
+                _Unlink( _Timer );
+                socket_timer::handler_type _Handler = _Timer._MyHandler;
+                if( _Handler )
+                    _Handler();
+                ++_Expired;
+                }
+            }
+        catch( ... )
+            { // the list lives on this stack frame, remaining timers expire on next advance
+            _Reinsert( _List );
+            throw;
+            }
+        return _Expired;
+        }
+
+    inline void _Reinsert( socket_timer*& _List ) noexcept
+        {   // move timers of the detached list back into the wheel
+        while( _List != nullptr )
+            { // timers keep their count while being moved
+            socket_timer& _Timer = *_List;
+            _List = _Timer._MyNext;
+            if( _List != nullptr )
+                _List->_MyPrev = &_List;
+            _Insert( _Timer );
+            }
+        }
+
+    _NODISCARD inline std::uint64_t _Next_tick() const noexcept
+        {   // get first tick at which any timer expires or has to be cascaded
+        std::uint64_t _Next = ~std::uint64_t( 0 );
+        for( unsigned int _Level = 0; _Level < _Levels; ++_Level )
+            {
+            const std::uint64_t _Occupied = this->_MyOccupied[_Level];
+            if( _Occupied == 0 )
+                continue;
+            const unsigned int _Shift = _Slot_bits * _Level;
+            const unsigned int _Current = static_cast<unsigned int>((this->_MyTick >> _Shift) & (_Slots - 1));
+            const std::uint64_t _Base = (this->_MyTick >> (_Shift + _Slot_bits)) << (_Shift + _Slot_bits);
+            const std::uint64_t _Ahead = _Occupied & (~std::uint64_t( 0 ) << _Current);
+            std::uint64_t _Tick;
+            if( _Ahead != 0 )
+                _Tick = _Base | (std::uint64_t( _Lowest_bit( _Ahead ) ) << _Shift);
+            else // only the top level wraps around
+                _Tick = _Base + (std::uint64_t( 1 ) << (_Shift + _Slot_bits)) + (std::uint64_t( _Lowest_bit( _Occupied ) ) << _Shift);
+            _Next = __impl::min( _Next, __impl::max( _Tick, this->_MyTick ) );
+            }
+        return _Next;
+        }
+
+    _NODISCARD static inline unsigned int _Lowest_bit( std::uint64_t _Mask ) noexcept
+        {   // get index of the lowest set bit, _Mask must not be 0
+#   if defined( _MSC_VER )
+        unsigned long _Index;
+        _BitScanForward64( &_Index, _Mask );
+        return static_cast<unsigned int>(_Index);
+#   else
+        return static_cast<unsigned int>(__builtin_ctzll( _Mask ));
+#   endif
+        }
+
+    friend class socket_timer;
+    };
+
+
+inline void socket_timer::cancel() noexcept
+    {   // remove timer from the wheel it is scheduled in
+    if( this->_MyWheel != nullptr )
+        this->_MyWheel->_Unlink( *this );
+    }
+
+
+#if defined( _LIBSOCK_HAS_COROUTINES )
+// STRUCT _Socket_async_operation
+struct _Socket_async_operation
+    {
+    bool (*_Perform)( _Socket_async_operation* _Op ) noexcept; // attempt operation, true when completed
+    void (*_Abort)( _Socket_async_operation* _Op, int _Errval ) noexcept; // complete operation with error
+    std::coroutine_handle<> _Continuation;
+    socket_timer* _Deadline; // cancelled when the operation completes
+    };
+#endif
+
+
+#if defined( OS_LINUX )
+// ENUM CLASS socket_events
+enum class socket_events : unsigned int
+    {
+    none                = 0,
+    in                  = EPOLLIN,          // data available for reading
+    out                 = EPOLLOUT,         // socket writable without blocking
+    priority            = EPOLLPRI,         // out-of-band data available
+    read_hangup         = EPOLLRDHUP,       // remote host shut down its sending side
+    error               = EPOLLERR,         // error condition (always reported)
+    hangup              = EPOLLHUP,         // connection closed (always reported)
+    edge_triggered      = EPOLLET,          // report only readiness transitions
+    oneshot             = EPOLLONESHOT,     // disable notifications after first event
+    exclusive           = EPOLLEXCLUSIVE    // wake only one of the reactors sharing the socket (add only)
+    };
+
+using _Socket_events_helper = _Socket_flags_helper<socket_events, unsigned int>;
+
+_NODISCARD inline _Socket_events_helper operator|( socket_events _1, socket_events _2 ) noexcept
+    {   // construct socket events helper from two flags
+    return _Socket_events_helper( _1 ) | _2;
+    }
+
+
+// CLASS socket_reactor
+class socket_reactor
+    {
+public:
+    typedef std::function<void( _Socket_events_helper )> handler_type;
+
+    socket_reactor( const socket_reactor& ) = delete;
+    socket_reactor& operator=( const socket_reactor& ) = delete;
+
+    inline explicit socket_reactor( size_t _Max_events = 256 )
+        : _MyEpoll( -1 )
+        , _MyWakeup( -1 )
+        , _MyEvents( _Max_events )
+        , _MyEntries()
+        , _MyRetired()
+#if defined( _LIBSOCK_HAS_COROUTINES )
+        , _MyAborted()
+#endif
+        , _MyCount( 0 )
+        , _MyStopped( false )
+        , _MyTimers()
+        {   // construct epoll-based reactor
+        _LIBSOCK_CHECK_ARG_NOT_EQ( _Max_events, 0 );
+        this->_MyEpoll = _Throw_if_failed( ::epoll_create1( EPOLL_CLOEXEC ) );
+        this->_MyWakeup = ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+        epoll_event _Event;
+        __impl::memset( &_Event, 0, sizeof( _Event ) );
+        _Event.events = EPOLLIN;
+        _Event.data.ptr = nullptr; // wakeup descriptor has no entry
+        if( this->_MyWakeup < 0
+            || ::epoll_ctl( this->_MyEpoll, EPOLL_CTL_ADD, this->_MyWakeup, &_Event ) < 0 )
+            { // release already acquired descriptors before reporting failure
+            const int _Errval = errno;
+            _Close();
+            throw socket_exception( _Errval );
+            }
+        }
+
+    inline ~socket_reactor() noexcept
+        {   // destroy reactor
+        _Close();
+        }
+
+    inline void add( const socket& _Socket, _Socket_events_helper _Events, handler_type _Handler )
+        {   // register socket in the reactor
+        _LIBSOCK_CHECK_ARG_NOT_NULL( _Handler );
+        _Add( _Socket.get_native_handle(), _Events, __impl::move( _Handler ) );
+        }
+
+    inline void attach( socket& _Socket )
+        {   // register socket for awaitable operations, switches it into non-blocking mode
+        if( _Socket._MyReactor == this )
+            return;
+        if( _Socket._MyReactor != nullptr )
+            throw std::invalid_argument( "socket is attached to another reactor" );
+        _Socket.set_nonblocking( true );
+        _Add( _Socket.get_native_handle(),
+            socket_events::in | socket_events::out | socket_events::read_hangup | socket_events::edge_triggered,
+            handler_type() );
+        _Socket._MyReactor = this;
+        }
+
+    inline void detach( socket& _Socket )
+        {   // unregister attached socket and switch it back into blocking mode
+        if( _Socket._MyReactor != this )
+            throw std::invalid_argument( "socket is not attached to this reactor" );
+        remove( _Socket );
+        _Socket._MyReactor = nullptr;
+        _Socket.set_nonblocking( false );
+        }
+
+    inline void remove( const socket& _Socket )
+        {   // unregister socket from the reactor
+        _Reactor_entry& _Entry = _Get_entry( _Socket.get_native_handle() );
+        _Throw_if_failed( ::epoll_ctl( this->_MyEpoll, EPOLL_CTL_DEL, _Entry._Handle, nullptr ) );
+        _Retire( _Entry );
+        }
+
+    inline void modify( const socket& _Socket, _Socket_events_helper _Events )
+        {   // change events the socket is registered for, re-arms oneshot registrations
+        _Reactor_entry& _Entry = _Get_entry( _Socket.get_native_handle() );
+        epoll_event _Event = _Make_event( _Events, &_Entry );
+        _Throw_if_failed( ::epoll_ctl( this->_MyEpoll, EPOLL_CTL_MOD, _Entry._Handle, &_Event ) );
+        }
+
+    inline void set_idle_timeout( const socket& _Socket, std::chrono::milliseconds _Timeout,
+            socket_timer::handler_type _Handler )
+        {   // call _Handler if no events are reported for the socket within _Timeout, 0 disables
+        _Reactor_entry& _Entry = _Get_entry( _Socket.get_native_handle() );
+        _Entry._Idle_timeout = _Timeout;
+        _Entry._Idle_timer.set_handler( __impl::move( _Handler ) );
+        if( _Timeout.count() > 0 )
+            this->_MyTimers.schedule( _Entry._Idle_timer, _Timeout );
+        else
+            _Entry._Idle_timer.cancel();
+        }
+
+    _NODISCARD inline timer_wheel& timers() noexcept
+        {   // get timers expired by the reactor
+        return this->_MyTimers;
+        }
+
+    _NODISCARD inline bool contains( const socket& _Socket ) const noexcept
+        {   // check if socket is registered in the reactor
+        const size_t _Index = static_cast<size_t>(_Socket.get_native_handle());
+        return _Socket.get_native_handle() != _Invalid_socket
+            && _Index < this->_MyEntries.size()
+            && this->_MyEntries[_Index] != nullptr;
+        }
+
+    _NODISCARD inline size_t size() const noexcept
+        {   // get number of registered sockets
+        return this->_MyCount;
+        }
+
+    inline size_t run_once( int _Timeout_ms = -1 )
+        {   // wait for events and dispatch them to the handlers, then expire due timers
+        const int _Timer_timeout = this->_MyTimers.next_timeout();
+        if( _Timer_timeout >= 0 && (_Timeout_ms < 0 || _Timer_timeout < _Timeout_ms) )
+            _Timeout_ms = _Timer_timeout;
+        const int _Count = ::epoll_wait( this->_MyEpoll,
+            this->_MyEvents.data(),
+            static_cast<int>(this->_MyEvents.size()),
+            _Timeout_ms );
+        if( _Count < 0 )
+            { // interrupted waits are not errors
+            if( errno == EINTR )
+                return 0;
+            throw socket_exception( errno );
+            }
+        size_t _Dispatched = 0;
+        for( int i = 0; i < _Count; ++i )
+            {
+            const epoll_event& _Event = this->_MyEvents[i];
+            _Reactor_entry* _Entry = reinterpret_cast<_Reactor_entry*>(_Event.data.ptr);
+            if( _Entry == nullptr )
+                { // wakeup request, drain the counter
+                eventfd_t _Value;
+                (void)::eventfd_read( this->_MyWakeup, &_Value );
+                continue;
+                }
+            if( _Entry->_Handle == _Invalid_socket )
+                { // socket removed by one of the previous handlers
+                continue;
+                }
+            if( _Entry->_Idle_timeout.count() > 0 )
+                this->_MyTimers.schedule( _Entry->_Idle_timer, _Entry->_Idle_timeout );
+            if( _Entry->_Handler )
+                _Entry->_Handler( _Socket_events_helper( static_cast<unsigned int>(_Event.events) ) );
+#if defined( _LIBSOCK_HAS_COROUTINES )
+            else
+                _Resume_waiters( *_Entry, _Event.events );
+#endif
+            ++_Dispatched;
+            }
+        _Dispatched += this->_MyTimers.advance();
+#if defined( _LIBSOCK_HAS_COROUTINES )
+        _Dispatched += _Resume_aborted();
+#endif
+        this->_MyRetired.clear();
+        return _Dispatched;
+        }
+
+    inline void run()
+        {   // dispatch events until stop is requested
+        this->_MyStopped = false;
+        while( !this->_MyStopped )
+            run_once();
+        }
+
+    inline void stop() noexcept
+        {   // request the reactor to stop, may be called from any thread
+        this->_MyStopped = true;
+        (void)::eventfd_write( this->_MyWakeup, 1 );
+        }
+
+    _NODISCARD inline bool stopped() const noexcept
+        {   // check if stop has been requested
+        return this->_MyStopped;
+        }
+
+    _NODISCARD inline int get_native_handle() const noexcept
+        {   // retrieve native epoll handle
+        return this->_MyEpoll;
+        }
+
+protected:
+    struct _Reactor_entry
+        {
+        inline _Reactor_entry( handler_type&& _Handler_fn, _Socket_handle _Native_handle ) noexcept
+            : _Handler( __impl::move( _Handler_fn ) )
+            , _Handle( _Native_handle )
+#if defined( _LIBSOCK_HAS_COROUTINES )
+            , _Waiters()
+#endif
+            , _Idle_timer()
+            , _Idle_timeout( 0 )
+            {   // construct entry without idle timeout
+            }
+
+        handler_type _Handler;
+        _Socket_handle _Handle;
+#if defined( _LIBSOCK_HAS_COROUTINES )
+        _Socket_async_operation* _Waiters[2]; // operations awaiting input and output readiness
+#endif
+        socket_timer _Idle_timer;
+        std::chrono::milliseconds _Idle_timeout;
+        };
+
+    int _MyEpoll;
+    int _MyWakeup;
+    std::vector<epoll_event> _MyEvents;
+    std::vector<std::unique_ptr<_Reactor_entry>> _MyEntries;
+    std::vector<std::unique_ptr<_Reactor_entry>> _MyRetired;
+#if defined( _LIBSOCK_HAS_COROUTINES )
+    std::vector<_Socket_async_operation*> _MyAborted; // operations of removed sockets, resumed by run_once
+#endif
+    size_t _MyCount;
+    std::atomic<bool> _MyStopped;
+    timer_wheel _MyTimers;
+
+    inline void _Add( _Socket_handle _Handle, _Socket_events_helper _Events, handler_type&& _Handler )
+        {   // register native handle in the reactor
+        _LIBSOCK_CHECK_ARG_NOT_EQ( _Handle, _Invalid_socket );
+        const size_t _Index = static_cast<size_t>(_Handle);
+        if( _Index >= this->_MyEntries.size() )
+            this->_MyEntries.resize( _Index + 1 );
+        if( this->_MyEntries[_Index] != nullptr )
+            throw std::invalid_argument( "socket is already registered in the reactor" );
+        std::unique_ptr<_Reactor_entry> _Entry( new _Reactor_entry( __impl::move( _Handler ), _Handle ) );
+        epoll_event _Event = _Make_event( _Events, _Entry.get() );
+        _Throw_if_failed( ::epoll_ctl( this->_MyEpoll, EPOLL_CTL_ADD, _Handle, &_Event ) );
+        this->_MyEntries[_Index] = __impl::move( _Entry );
+        ++this->_MyCount;
+        }
+
+    inline void _Retire( _Reactor_entry& _Entry )
+        {   // remove entry from the handle table
+        const size_t _Index = static_cast<size_t>(_Entry._Handle);
+        // Entry may be referenced by events already returned from epoll_wait or by the
+        // handler currently running, keep it alive until the dispatch loop completes.
+        _Entry._Handle = _Invalid_socket;
+        _Entry._Idle_timer.cancel();
+#if defined( _LIBSOCK_HAS_COROUTINES )
+        // Waiting coroutines fail with ECANCELED. They are resumed by the dispatch loop,
+        // the socket may be in the middle of being closed here.
+        this->_MyAborted.reserve( this->_MyAborted.size() + 2 );
+        for( _Socket_async_operation*& _Op : _Entry._Waiters )
+            {
+            if( _Op == nullptr )
+                continue;
+            if( _Op->_Deadline != nullptr )
+                _Op->_Deadline->cancel();
+            this->_MyAborted.push_back( _Op );
+            _Op = nullptr;
+            }
+        if( !this->_MyAborted.empty() )
+            (void)::eventfd_write( this->_MyWakeup, 1 );
+#endif
+        this->_MyRetired.push_back( __impl::move( this->_MyEntries[_Index] ) );
+        --this->_MyCount;
+        }
+
+    inline void _Detach( socket& _Socket ) noexcept
+        {   // unregister attached socket which is about to be closed
+        const size_t _Index = static_cast<size_t>(_Socket.get_native_handle());
+        if( _Index < this->_MyEntries.size() && this->_MyEntries[_Index] != nullptr )
+            { // closing the handle removes it from the epoll set
+            try { _Retire( *this->_MyEntries[_Index] ); }
+            catch( ... ) { this->_MyEntries[_Index].reset(); --this->_MyCount; }
+            }
+        _Socket._MyReactor = nullptr;
+        }
+
+#if defined( _LIBSOCK_HAS_COROUTINES )
+    inline void _Wait( _Socket_handle _Handle, int _Direction, _Socket_async_operation* _Op )
+        {   // register operation awaiting readiness of the socket
+        _Reactor_entry& _Entry = _Get_entry( _Handle );
+        if( _Entry._Waiters[_Direction] != nullptr )
+            throw std::logic_error( "another operation is already awaiting the socket" );
+        _Entry._Waiters[_Direction] = _Op;
+        }
+
+    inline void _Resume_waiters( _Reactor_entry& _Entry, unsigned int _Events )
+        {   // retry operations awaiting readiness of the socket
+        if( (_Events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)) != 0 )
+            _Resume_waiter( _Entry, 0 );
+        // resumed coroutine may have closed the socket
+        if( (_Events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) != 0 && _Entry._Handle != _Invalid_socket )
+            _Resume_waiter( _Entry, 1 );
+        }
+
+    inline void _Resume_waiter( _Reactor_entry& _Entry, int _Direction )
+        {   // resume coroutine if its operation completes
+        _Socket_async_operation* _Op = _Entry._Waiters[_Direction];
+        if( _Op != nullptr && _Op->_Perform( _Op ) )
+            {
+            _Entry._Waiters[_Direction] = nullptr;
+            if( _Op->_Deadline != nullptr )
+                _Op->_Deadline->cancel();
+            _Op->_Continuation.resume();
+            }
+        }
+
+    inline size_t _Resume_aborted() noexcept
+        {   // resume operations of the sockets removed from the reactor
+        size_t _Resumed = 0;
+        while( !this->_MyAborted.empty() )
+            { // resumed coroutines may remove further sockets
+            _Socket_async_operation* const _Op = this->_MyAborted.back();
+            this->_MyAborted.pop_back();
+            _Op->_Abort( _Op, ECANCELED );
+            ++_Resumed;
+            }
+        return _Resumed;
+        }
+
+    inline void _Cancel_wait( _Socket_handle _Handle, int _Direction, _Socket_async_operation* _Op ) noexcept
+        {   // remove operation which no longer awaits readiness of the socket
+        const size_t _Index = static_cast<size_t>(_Handle);
+        if( _Handle != _Invalid_socket
+            && _Index < this->_MyEntries.size()
+            && this->_MyEntries[_Index] != nullptr
+            && this->_MyEntries[_Index]->_Waiters[_Direction] == _Op )
+            {
+            this->_MyEntries[_Index]->_Waiters[_Direction] = nullptr;
+            }
+        }
+#endif
+
+    _NODISCARD inline _Reactor_entry& _Get_entry( _Socket_handle _Handle ) const
+        {   // get entry of the registered socket
+        const size_t _Index = static_cast<size_t>(_Handle);
+        if( _Handle == _Invalid_socket
+            || _Index >= this->_MyEntries.size()
+            || this->_MyEntries[_Index] == nullptr )
+            {
+            throw std::invalid_argument( "socket is not registered in the reactor" );
+            }
+        return *this->_MyEntries[_Index];
+        }
+
+    _NODISCARD static inline epoll_event _Make_event( _Socket_events_helper _Events, _Reactor_entry* _Entry ) noexcept
+        {   // construct epoll event structure
+        epoll_event _Event;
+        __impl::memset( &_Event, 0, sizeof( _Event ) );
+        _Event.events = static_cast<uint32_t>(static_cast<unsigned int>(_Events));
+        _Event.data.ptr = _Entry;
+        return _Event;
+        }
+
+    inline void _Close() noexcept
+        {   // close native handles
+        if( this->_MyWakeup >= 0 )
+            ::close( this->_MyWakeup );
+        if( this->_MyEpoll >= 0 )
+            ::close( this->_MyEpoll );
+        this->_MyWakeup = -1;
+        this->_MyEpoll = -1;
+        }
+
+    friend class socket;
+#if defined( _LIBSOCK_HAS_COROUTINES )
+    friend class _Socket_io_awaitable;
+#endif
+    };
+
+
+inline void socket::_Detach_reactor() noexcept
+    {   // unregister socket from the reactor it is attached to
+    if( this->_MyReactor != nullptr )
+        this->_MyReactor->_Detach( *this );
+    }
+
+#else
+
+inline void socket::_Detach_reactor() noexcept
+    {   // reactors are not available on this OS
+    }
+#endif// OS_LINUX
+
+
+#if defined( _LIBSOCK_HAS_IO_URING )
+// ENUM CLASS socket_operation
+enum class socket_operation
+    {
+    accept,
+    recv,
+    send,
+    connect,
+    cancel
+    };
+
+
+// STRUCT socket_completion
+struct socket_completion
+    {
+    socket_operation operation;
+    int result;                 // byte count or accepted handle, negative on failure
+    std::error_code error;      // error reported by the operation
+    socket accepted;            // connection accepted by accept operations
+    const void* data;           // received data of provided-buffer operations
+    size_t size;                // size of the received data
+    bool more;                  // multishot operation will produce more completions
+
+    _NODISCARD inline explicit operator bool() const noexcept
+        {   // check if operation succeeded
+        return !this->error;
+        }
+    };
+
+
+// CLASS socket_proactor
+class socket_proactor
+    {
+public:
+    typedef std::function<void( socket_completion& )> handler_type;
+
+    socket_proactor( const socket_proactor& ) = delete;
+    socket_proactor& operator=( const socket_proactor& ) = delete;
+
+    inline explicit socket_proactor( unsigned int _Entries = 256 )
+        : _MyRing( -1 )
+        , _MySq_ptr( nullptr ), _MySq_size( 0 )
+        , _MyCq_ptr( nullptr ), _MyCq_size( 0 )
+        , _MySqes( nullptr ), _MySqes_size( 0 )
+        , _MySq_tail( 0 ), _MySq_pending( 0 )
+        , _MyOperations(), _MyFree(), _MyGroups()
+        {   // construct io_uring-based proactor
+        _LIBSOCK_CHECK_ARG_NOT_EQ( _Entries, 0 );
+        io_uring_params _Params;
+        __impl::memset( &_Params, 0, sizeof( _Params ) );
+        this->_MyRing = _Throw_if_failed( static_cast<int>(
+            ::syscall( __NR_io_uring_setup, _Entries, &_Params ) ) );
+        try
+            {
+            _Map_rings( _Params );
+            }
+        catch( ... )
+            {
+            _Close();
+            throw;
+            }
+        }
+
+    inline ~socket_proactor() noexcept
+        {   // destroy proactor, pending operations are abandoned
+        _Close();
+        }
+
+    inline void accept( socket& _Listener, handler_type _Handler )
+        {   // submit accept operation, _Listener must outlive the operation
+        io_uring_sqe* _Sqe = _Prepare( IORING_OP_ACCEPT, _Listener,
+            socket_operation::accept, __impl::move( _Handler ) );
+        _Sqe->accept_flags = SOCK_CLOEXEC;
+        }
+
+    inline void accept_multishot( socket& _Listener, handler_type _Handler )
+        {   // submit accept operation completing once per accepted connection
+        io_uring_sqe* _Sqe = _Prepare( IORING_OP_ACCEPT, _Listener,
+            socket_operation::accept, __impl::move( _Handler ) );
+        _Sqe->accept_flags = SOCK_CLOEXEC;
+        _Sqe->ioprio |= IORING_ACCEPT_MULTISHOT;
+        }
+
+    inline void recv( socket& _Socket, void* _Data, size_t _ByteSize, handler_type _Handler,
+            _Socket_recv_flags_helper _Flags = socket_recv_flags::none )
+        {   // submit receive operation, _Data must stay valid until completion
+        io_uring_sqe* _Sqe = _Prepare( IORING_OP_RECV, _Socket,
+            socket_operation::recv, __impl::move( _Handler ) );
+        _Sqe->addr = reinterpret_cast<__u64>(_Data);
+        _Sqe->len = static_cast<__u32>(_ByteSize);
+        _Sqe->msg_flags = static_cast<__u32>(static_cast<int>(_Flags));
+        }
+
+    inline void recv_multishot( socket& _Socket, unsigned short _Group, handler_type _Handler,
+            _Socket_recv_flags_helper _Flags = socket_recv_flags::none )
+        {   // submit receive operation completing once per message received into provided buffers
+        (void)_Get_group( _Group );
+        io_uring_sqe* _Sqe = _Prepare( IORING_OP_RECV, _Socket,
+            socket_operation::recv, __impl::move( _Handler ) );
+        _Sqe->msg_flags = static_cast<__u32>(static_cast<int>(_Flags));
+        _Sqe->ioprio |= IORING_RECV_MULTISHOT;
+        _Sqe->flags |= IOSQE_BUFFER_SELECT;
+        _Sqe->buf_group = _Group;
+        this->_MyOperations[static_cast<size_t>(_Sqe->user_data) - 1]._Group = _Group;
+        }
+
+    inline void send( socket& _Socket, const void* _Data, size_t _ByteSize, handler_type _Handler,
+            _Socket_send_flags_helper _Flags = socket_send_flags::none )
+        {   // submit send operation, _Data must stay valid until completion
+        io_uring_sqe* _Sqe = _Prepare( IORING_OP_SEND, _Socket,
+            socket_operation::send, __impl::move( _Handler ) );
+        _Sqe->addr = reinterpret_cast<__u64>(_Data);
+        _Sqe->len = static_cast<__u32>(_ByteSize);
+        _Sqe->msg_flags = static_cast<__u32>(static_cast<int>(_Flags) | MSG_NOSIGNAL);
+        }
+
+    inline void connect( socket& _Socket, const socket_address_storage& _Addr, handler_type _Handler )
+        {   // submit connect operation
+        const size_t _Addrlen = _Addr.get_native_sockaddr_size();
+        if( _Addrlen > sizeof( sockaddr_storage ) )
+            throw std::invalid_argument( "unsupported socket address size" );
+        io_uring_sqe* _Sqe = _Prepare( IORING_OP_CONNECT, _Socket,
+            socket_operation::connect, __impl::move( _Handler ) );
+        // address is copied into the operation slot, which is stable until completion
+        _Operation& _Op = this->_MyOperations[static_cast<size_t>(_Sqe->user_data) - 1];
+        __impl::memcpy( &_Op._Addr, _Addr.get_native_sockaddr(), _Addrlen );
+        _Sqe->addr = reinterpret_cast<__u64>(&_Op._Addr);
+        _Sqe->off = static_cast<__u64>(_Addrlen);
+        }
+
+    inline void cancel( const socket& _Socket )
+        {   // cancel all pending operations of the socket, including multishot ones
+        io_uring_sqe* _Sqe = _Get_sqe();
+        _Sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        _Sqe->fd = _Socket.get_native_handle();
+        _Sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+        _Sqe->user_data = 0; // completion of the cancel request itself is not reported
+        }
+
+    inline void provide_buffers( unsigned short _Group, unsigned int _Count, size_t _ByteSize )
+        {   // register ring of kernel-selected receive buffers
+        _LIBSOCK_CHECK_ARG_NOT_EQ( _ByteSize, 0 );
+        if( _Count == 0 || _Count > 32768 || (_Count & (_Count - 1)) != 0 )
+            throw std::invalid_argument( "_Count must be a power of 2 not greater than 32768" );
+        for( const auto& _Existing : this->_MyGroups )
+            if( _Existing->_Id == _Group )
+                throw std::invalid_argument( "buffer group is already registered" );
+        std::unique_ptr<_Buffer_group> _Grp( new _Buffer_group( _Group, _Count, _ByteSize ) );
+        io_uring_buf_reg _Reg;
+        __impl::memset( &_Reg, 0, sizeof( _Reg ) );
+        _Reg.ring_addr = reinterpret_cast<__u64>(_Grp->_Ring);
+        _Reg.ring_entries = _Count;
+        _Reg.bgid = _Group;
+        _Throw_if_failed( static_cast<int>( ::syscall( __NR_io_uring_register,
+            this->_MyRing, IORING_REGISTER_PBUF_RING, &_Reg, 1 ) ) );
+        for( unsigned int i = 0; i < _Count; ++i )
+            _Grp->_Recycle( static_cast<unsigned short>(i) );
+        _Grp->_Publish();
+        this->_MyGroups.push_back( __impl::move( _Grp ) );
+        }
+
+    inline size_t submit()
+        {   // submit all prepared operations to the kernel
+        return _Enter( 0, 0 );
+        }
+
+    inline size_t run_once( bool _Wait = true )
+        {   // submit prepared operations, wait for completions and dispatch them
+        _Enter( _Wait ? 1 : 0, _Wait ? IORING_ENTER_GETEVENTS : 0 );
+        return _Reap();
+        }
+
+    _NODISCARD inline size_t pending() const noexcept
+        {   // get number of operations in flight
+        return this->_MyOperations.size() - this->_MyFree.size();
+        }
+
+    _NODISCARD inline int get_native_handle() const noexcept
+        {   // retrieve native io_uring handle
+        return this->_MyRing;
+        }
+
+protected:
+    struct _Operation
+        {
+        handler_type _Handler;
+        socket* _Socket;
+        socket_operation _Kind;
+        unsigned short _Group;
+        sockaddr_storage _Addr;
+        };
+
+    struct _Buffer_group
+        {
+        unsigned short _Id;
+        unsigned int _Count;
+        size_t _Size;
+        size_t _Ring_size;
+        io_uring_buf* _Ring;
+        std::vector<char> _Storage;
+        unsigned short _Tail;
+
+        inline _Buffer_group( unsigned short _Group, unsigned int _Entries, size_t _ByteSize )
+            : _Id( _Group ), _Count( _Entries ), _Size( _ByteSize )
+            , _Ring_size( _Entries * sizeof( io_uring_buf ) ), _Ring( nullptr )
+            , _Storage( _Entries * _ByteSize ), _Tail( 0 )
+            {   // allocate page-aligned buffer ring and buffers storage
+            void* _Ptr = ::mmap( nullptr, _Ring_size, PROT_READ | PROT_WRITE,
+                MAP_ANONYMOUS | MAP_PRIVATE, -1, 0 );
+            if( _Ptr == MAP_FAILED )
+                throw socket_exception( errno );
+            this->_Ring = reinterpret_cast<io_uring_buf*>(_Ptr);
+            }
+
+        inline ~_Buffer_group() noexcept
+            {   // release buffer ring memory
+            ::munmap( this->_Ring, this->_Ring_size );
+            }
+
+        _NODISCARD inline char* _Buffer( unsigned short _Bid ) noexcept
+            {   // get buffer of given id
+            return this->_Storage.data() + static_cast<size_t>(_Bid) * this->_Size;
+            }
+
+        inline void _Recycle( unsigned short _Bid ) noexcept
+            {   // add buffer to the ring, visible to the kernel after _Publish
+            io_uring_buf& _Buf = this->_Ring[this->_Tail & (this->_Count - 1)];
+            _Buf.addr = reinterpret_cast<__u64>(_Buffer( _Bid ));
+            _Buf.len = static_cast<__u32>(this->_Size);
+            _Buf.bid = _Bid;
+            ++this->_Tail;
+            }
+
+        inline void _Publish() noexcept
+            {   // make recycled buffers visible to the kernel
+            // Ring tail overlays reserved field of the first entry. io_uring_buf_ring is not
+            // used directly, since its flexible array member is laid out differently in C++.
+            __atomic_store_n( &this->_Ring[0].resv, this->_Tail, __ATOMIC_RELEASE );
+            }
+        };
+
+    int _MyRing;
+    void* _MySq_ptr;
+    size_t _MySq_size;
+    void* _MyCq_ptr;
+    size_t _MyCq_size;
+    io_uring_sqe* _MySqes;
+    size_t _MySqes_size;
+
+    unsigned int* _MySq_khead;
+    unsigned int* _MySq_ktail;
+    unsigned int _MySq_mask;
+    unsigned int _MySq_entries;
+    unsigned int _MySq_tail;
+    unsigned int _MySq_pending;
+
+    unsigned int* _MyCq_khead;
+    unsigned int* _MyCq_ktail;
+    unsigned int _MyCq_mask;
+    io_uring_cqe* _MyCqes;
+
+    // deque keeps operation addresses stable while handlers submit new operations
+    std::deque<_Operation> _MyOperations;
+    std::vector<size_t> _MyFree;
+    std::vector<std::unique_ptr<_Buffer_group>> _MyGroups;
+
+    template<typename _Ty>
+    _NODISCARD inline _Ty* _Ring_field( void* _Base, __u32 _Offset ) const noexcept
+        {   // get pointer to the field of the mapped ring
+        return reinterpret_cast<_Ty*>(reinterpret_cast<char*>(_Base) + _Offset);
+        }
+
+    inline void _Map_rings( const io_uring_params& _Params )
+        {   // map submission and completion rings into the process memory
+        this->_MySq_size = _Params.sq_off.array + _Params.sq_entries * sizeof( unsigned int );
+        this->_MyCq_size = _Params.cq_off.cqes + _Params.cq_entries * sizeof( io_uring_cqe );
+        const bool _Single_mmap = (_Params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if( _Single_mmap )
+            this->_MySq_size = this->_MyCq_size = __impl::max( this->_MySq_size, this->_MyCq_size );
+        this->_MySq_ptr = _Map( this->_MySq_size, IORING_OFF_SQ_RING );
+        this->_MyCq_ptr = _Single_mmap ? this->_MySq_ptr : _Map( this->_MyCq_size, IORING_OFF_CQ_RING );
+        this->_MySqes_size = _Params.sq_entries * sizeof( io_uring_sqe );
+        this->_MySqes = reinterpret_cast<io_uring_sqe*>(_Map( this->_MySqes_size, IORING_OFF_SQES ));
+
+        this->_MySq_khead = _Ring_field<unsigned int>( this->_MySq_ptr, _Params.sq_off.head );
+        this->_MySq_ktail = _Ring_field<unsigned int>( this->_MySq_ptr, _Params.sq_off.tail );
+        this->_MySq_mask = *_Ring_field<unsigned int>( this->_MySq_ptr, _Params.sq_off.ring_mask );
+        this->_MySq_entries = _Params.sq_entries;
+        this->_MySq_tail = *this->_MySq_ktail;
+        unsigned int* _Array = _Ring_field<unsigned int>( this->_MySq_ptr, _Params.sq_off.array );
+        for( unsigned int i = 0; i < _Params.sq_entries; ++i )
+            _Array[i] = i; // sqes are always used in the ring order
+
+        this->_MyCq_khead = _Ring_field<unsigned int>( this->_MyCq_ptr, _Params.cq_off.head );
+        this->_MyCq_ktail = _Ring_field<unsigned int>( this->_MyCq_ptr, _Params.cq_off.tail );
+        this->_MyCq_mask = *_Ring_field<unsigned int>( this->_MyCq_ptr, _Params.cq_off.ring_mask );
+        this->_MyCqes = _Ring_field<io_uring_cqe>( this->_MyCq_ptr, _Params.cq_off.cqes );
+        }
+
+    _NODISCARD inline void* _Map( size_t _Size, off_t _Offset ) const
+        {   // map io_uring memory region
+        void* _Ptr = ::mmap( nullptr, _Size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, this->_MyRing, _Offset );
+        if( _Ptr == MAP_FAILED )
+            throw socket_exception( errno );
+        return _Ptr;
+        }
+
+    _NODISCARD inline io_uring_sqe* _Get_sqe()
+        {   // get next free submission queue entry, flushing the queue when full
+        if( this->_MySq_tail - __atomic_load_n( this->_MySq_khead, __ATOMIC_ACQUIRE ) >= this->_MySq_entries )
+            _Enter( 0, 0 );
+        if( this->_MySq_tail - __atomic_load_n( this->_MySq_khead, __ATOMIC_ACQUIRE ) >= this->_MySq_entries )
+            throw socket_exception( EBUSY, "io_uring submission queue is full" );
+        io_uring_sqe* _Sqe = &this->_MySqes[this->_MySq_tail & this->_MySq_mask];
+        __impl::memset( _Sqe, 0, sizeof( io_uring_sqe ) );
+        ++this->_MySq_tail;
+        ++this->_MySq_pending;
+        return _Sqe;
+        }
+
+    _NODISCARD inline io_uring_sqe* _Prepare( __u8 _Opcode, socket& _Socket, socket_operation _Kind, handler_type&& _Handler )
+        {   // prepare submission queue entry of the operation
+        _LIBSOCK_CHECK_ARG_NOT_NULL( _Handler );
+        _LIBSOCK_CHECK_ARG_NOT_EQ( _Socket.get_native_handle(), _Invalid_socket );
+        io_uring_sqe* _Sqe = _Get_sqe();
+        size_t _Index;
+        if( !this->_MyFree.empty() )
+            { // reuse slot of completed operation
+            _Index = this->_MyFree.back();
+            this->_MyFree.pop_back();
+            }
+        else
+            {
+            _Index = this->_MyOperations.size();
+            this->_MyOperations.emplace_back();
+            }
+        _Operation& _Op = this->_MyOperations[_Index];
+        _Op._Handler = __impl::move( _Handler );
+        _Op._Socket = &_Socket;
+        _Op._Kind = _Kind;
+        _Sqe->opcode = _Opcode;
+        _Sqe->fd = _Socket.get_native_handle();
+        _Sqe->user_data = static_cast<__u64>(_Index + 1);
+        return _Sqe;
+        }
+
+    inline size_t _Enter( unsigned int _Min_complete, unsigned int _Flags )
+        {   // publish prepared entries and enter the kernel
+        const unsigned int _To_submit = this->_MySq_pending;
+        if( _To_submit == 0 && _Flags == 0 )
+            return 0;
+        __atomic_store_n( this->_MySq_ktail, this->_MySq_tail, __ATOMIC_RELEASE );
+        int _Submitted;
+        do
+            {
+            _Submitted = static_cast<int>( ::syscall( __NR_io_uring_enter,
+                this->_MyRing, _To_submit, _Min_complete, _Flags, nullptr, 0 ) );
+            } while( _Submitted < 0 && errno == EINTR );
+        _Throw_if_failed( _Submitted );
+        this->_MySq_pending -= static_cast<unsigned int>(_Submitted);
+        return static_cast<size_t>(_Submitted);
+        }
+
+    inline size_t _Reap()
+        {   // dispatch all available completions
+        size_t _Dispatched = 0;
+        unsigned int _Head = *this->_MyCq_khead;
+        while( _Head != __atomic_load_n( this->_MyCq_ktail, __ATOMIC_ACQUIRE ) )
+            {
+            const io_uring_cqe _Cqe = this->_MyCqes[_Head & this->_MyCq_mask];
+            __atomic_store_n( this->_MyCq_khead, ++_Head, __ATOMIC_RELEASE );
+            if( _Cqe.user_data == 0 )
+                continue;
+            _Complete( static_cast<size_t>(_Cqe.user_data) - 1, _Cqe );
+            ++_Dispatched;
+            }
+        return _Dispatched;
+        }
+
+    inline void _Complete( size_t _Index, const io_uring_cqe& _Cqe )
+        {   // invoke handler of the completed operation
+        _Operation& _Op = this->_MyOperations[_Index];
+        socket_completion _Completion{};
+        _Completion.operation = _Op._Kind;
+        _Completion.result = _Cqe.res;
+        _Completion.more = (_Cqe.flags & IORING_CQE_F_MORE) != 0;
+        if( _Cqe.res < 0 )
+            _Completion.error = std::error_code( -_Cqe.res, socket_category() );
+        else if( _Op._Kind == socket_operation::accept )
+            { // wrap accepted handle into the socket object with listener's properties
+            _Completion.accepted = socket( static_cast<_Socket_handle>(_Cqe.res),
+                _Op._Socket->_MyAddr_family, _Op._Socket->_MyType, _Op._Socket->_MyProtocol );
+            }
+        else if( _Op._Kind == socket_operation::recv )
+            _Completion.size = static_cast<size_t>(_Cqe.res);
+
+        _Buffer_group* _Group = nullptr;
+        unsigned short _Bid = 0;
+        if( (_Cqe.flags & IORING_CQE_F_BUFFER) != 0 )
+            { // data has been received into one of the provided buffers
+            _Bid = static_cast<unsigned short>(_Cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            _Group = &_Get_group( _Op._Group );
+            _Completion.data = _Group->_Buffer( _Bid );
+            }
+
+        if( _Completion.more )
+            { // operation stays in flight, handler is invoked in place
+            _Op._Handler( _Completion );
+            }
+        else
+            { // release slot before invoking the handler, so it can submit new operations
+            handler_type _Handler = __impl::move( _Op._Handler );
+            _Op._Socket = nullptr;
+            this->_MyFree.push_back( _Index );
+            _Handler( _Completion );
+            }
+
+        if( _Group != nullptr )
+            { // return consumed buffer to the kernel
+            _Group->_Recycle( _Bid );
+            _Group->_Publish();
+            }
+        }
+
+    _NODISCARD inline _Buffer_group& _Get_group( unsigned short _Group ) const
+        {   // get registered buffer group
+        for( const auto& _Grp : this->_MyGroups )
+            if( _Grp->_Id == _Group )
+                return *_Grp;
+        throw std::invalid_argument( "buffer group is not registered" );
+        }
+
+    inline void _Close() noexcept
+        {   // release io_uring resources
+        if( this->_MySqes != nullptr )
+            ::munmap( this->_MySqes, this->_MySqes_size );
+        if( this->_MyCq_ptr != nullptr && this->_MyCq_ptr != this->_MySq_ptr )
+            ::munmap( this->_MyCq_ptr, this->_MyCq_size );
+        if( this->_MySq_ptr != nullptr )
+            ::munmap( this->_MySq_ptr, this->_MySq_size );
+        if( this->_MyRing >= 0 )
+            ::close( this->_MyRing );
+        // buffer rings are unregistered together with the io_uring instance
+        this->_MyGroups.clear();
+        this->_MySqes = nullptr;
+        this->_MyCq_ptr = nullptr;
+        this->_MySq_ptr = nullptr;
+        this->_MyRing = -1;
+        }
+    };
+#endif// _LIBSOCK_HAS_IO_URING
+
+
+#if defined( _LIBSOCK_HAS_COROUTINES )
+// CLASS socket_task
+class socket_task
+    {   // detached coroutine, started eagerly and destroyed on completion
+public:
+    struct promise_type
+        {
+        _NODISCARD inline socket_task get_return_object() const noexcept
+            {   // construct task object
+            return socket_task();
+            }
+
+        _NODISCARD inline std::suspend_never initial_suspend() const noexcept
+            {   // start coroutine immediately
+            return {};
+            }
+
+        _NODISCARD inline std::suspend_never final_suspend() const noexcept
+            {   // destroy coroutine frame on completion
+            return {};
+            }
+
+        inline void return_void() const noexcept
+            {   // complete coroutine
+            }
+
+        inline void unhandled_exception() const noexcept
+            {   // nothing can observe the exception, behave as std::thread does
+            std::terminate();
+            }
+        };
+    };
+
+
+// CLASS _Socket_io_awaitable
+class _Socket_io_awaitable
+    : public _Socket_async_operation
+    {
+public:
+    _NODISCARD inline bool await_ready() noexcept
+        {   // attempt operation without suspending
+        return this->_Perform( this );
+        }
+
+    inline void await_suspend( std::coroutine_handle<> _Handle )
+        {   // wait for readiness of the socket
+        if( this->_MySocket->get_reactor() == nullptr )
+            throw std::runtime_error( "socket is not attached to any reactor" );
+        this->_Continuation = _Handle;
+        this->_MySocket->get_reactor()->_Wait( this->_MySocket->get_native_handle(), this->_MyDirection, this );
+        if( this->_MyTimeout.count() > 0 )
+            { // operation is cancelled if the socket does not become ready in time
+            this->_MyTimer.set_handler( [this]() { _Expire(); } );
+            this->_MySocket->get_reactor()->timers().schedule( this->_MyTimer, this->_MyTimeout );
+            this->_Deadline = &this->_MyTimer;
+            }
+        }
+
+protected:
+    socket* _MySocket;
+    int _MyDirection;
+    int _MyResult;
+    int _MyError;
+    std::chrono::milliseconds _MyTimeout;
+    socket_timer _MyTimer;
+    bool _MyClose_on_timeout; // operation cannot be abandoned without closing the socket
+
+    inline _Socket_io_awaitable( socket& _Socket, int _Direction,
+            bool (*_Perform_fn)( _Socket_async_operation* ) noexcept ) noexcept
+        : _Socket_async_operation{ _Perform_fn, &_Socket_io_awaitable::_Abort_operation, nullptr, nullptr }
+        , _MySocket( &_Socket )
+        , _MyDirection( _Direction )
+        , _MyResult( 0 )
+        , _MyError( 0 )
+        , _MyTimeout( 0 )
+        , _MyTimer()
+        , _MyClose_on_timeout( false )
+        {   // construct awaitable operation
+        }
+
+    static inline void _Abort_operation( _Socket_async_operation* _Op, int _Errval ) noexcept
+        {   // socket has been removed from the reactor while the operation was waiting
+        _Socket_io_awaitable* _Self = static_cast<_Socket_io_awaitable*>(_Op);
+        _Self->_MyError = _Errval;
+        _Self->_Continuation.resume();
+        }
+
+    inline void _Expire() noexcept
+        {   // socket did not become ready before the deadline
+        socket_reactor* _Reactor = this->_MySocket->get_reactor();
+        if( _Reactor != nullptr )
+            _Reactor->_Cancel_wait( this->_MySocket->get_native_handle(), this->_MyDirection, this );
+        if( this->_MyClose_on_timeout )
+            this->_MySocket->_Close();
+        this->_MyError = ETIMEDOUT;
+        this->_Continuation.resume();
+        }
+
+    _NODISCARD static inline bool _Interrupted( const std::error_code& _Error ) noexcept
+        {   // check if the call has been interrupted by a signal and has to be repeated
+        return _Error.value() == EINTR;
+        }
+
+    _NODISCARD inline bool _Complete( const socket_result<int>& _Result ) noexcept
+        {   // store operation result, false if the operation has to wait for readiness
+        if( _Result )
+            this->_MyResult = _Result.value;
+        return _Complete_status( _Result.error, _Result.would_block );
+        }
+
+    _NODISCARD inline bool _Complete_status( const std::error_code& _Error, bool _Would_block ) noexcept
+        {   // store operation error, false if the operation has to wait for readiness
+        if( _Would_block )
+            return false;
+        this->_MyError = _Error.value();
+        return true;
+        }
+
+    inline int _Get_result() const
+        {   // get operation result, throw if the operation failed
+        if( this->_MyError != 0 )
+            throw socket_exception( this->_MyError );
+        return this->_MyResult;
+        }
+    };
+
+
+// CLASS TEMPLATE _Socket_timed_awaitable
+template<typename _Derived>
+class _Socket_timed_awaitable
+    : public _Socket_io_awaitable
+    {   // awaitable operation which may be limited in time
+public:
+    _NODISCARD inline _Derived with_timeout( std::chrono::milliseconds _Timeout ) && noexcept
+        {   // fail with ETIMEDOUT if the operation does not complete within _Timeout
+        this->_MyTimeout = _Timeout;
+        return __impl::move( static_cast<_Derived&>(*this) );
+        }
+
+protected:
+    using _Socket_io_awaitable::_Socket_io_awaitable;
+    };
+
+
+// CLASS _Socket_send_awaitable
+class _Socket_send_awaitable
+    : public _Socket_timed_awaitable<_Socket_send_awaitable>
+    {
+public:
+    inline _Socket_send_awaitable( socket& _Socket, const void* _Data, size_t _ByteSize, int _Flags ) noexcept
+        : _Socket_timed_awaitable( _Socket, 1, &_Socket_send_awaitable::_Perform_send )
+        , _MyData( _Data ), _MySize( _ByteSize ), _MyFlags( _Flags )
+        {   // construct send operation
+        }
+
+    inline int await_resume() const
+        {   // get number of bytes sent
+        return _Get_result();
+        }
+
+
+protected:
+    const void* _MyData;
+    size_t _MySize;
+    int _MyFlags;
+
+    static inline bool _Perform_send( _Socket_async_operation* _Op ) noexcept
+        {   // attempt to send data
+        _Socket_send_awaitable* _Self = static_cast<_Socket_send_awaitable*>(_Op);
+        for( ;; )
+            {
+            const socket_result<int> _Result = _Self->_MySocket->send( _Self->_MyData, _Self->_MySize, std::nothrow,
+                _Socket_send_flags_helper( _Self->_MyFlags ) );
+            if( !_Interrupted( _Result.error ) )
+                return _Self->_Complete( _Result );
+            }
+        }
+    };
+
+
+// CLASS _Socket_recv_awaitable
+class _Socket_recv_awaitable
+    : public _Socket_timed_awaitable<_Socket_recv_awaitable>
+    {
+public:
+    inline _Socket_recv_awaitable( socket& _Socket, void* _Data, size_t _ByteSize, int _Flags ) noexcept
+        : _Socket_timed_awaitable( _Socket, 0, &_Socket_recv_awaitable::_Perform_recv )
+        , _MyData( _Data ), _MySize( _ByteSize ), _MyFlags( _Flags )
+        {   // construct receive operation
+        }
+
+    inline int await_resume() const
+        {   // get number of bytes received
+        return _Get_result();
+        }
+
+
+protected:
+    void* _MyData;
+    size_t _MySize;
+    int _MyFlags;
+
+    static inline bool _Perform_recv( _Socket_async_operation* _Op ) noexcept
+        {   // attempt to receive data
+        _Socket_recv_awaitable* _Self = static_cast<_Socket_recv_awaitable*>(_Op);
+        for( ;; )
+            {
+            const socket_result<int> _Result = _Self->_MySocket->recv( _Self->_MyData, _Self->_MySize, std::nothrow,
+                _Socket_recv_flags_helper( _Self->_MyFlags ) );
+            if( !_Interrupted( _Result.error ) )
+                return _Self->_Complete( _Result );
+            }
+        }
+    };
+
+
+// CLASS _Socket_accept_awaitable
+class _Socket_accept_awaitable
+    : public _Socket_timed_awaitable<_Socket_accept_awaitable>
+    {
+public:
+    inline explicit _Socket_accept_awaitable( socket& _Listener ) noexcept
+        : _Socket_timed_awaitable( _Listener, 0, &_Socket_accept_awaitable::_Perform_accept )
+        {   // construct accept operation
+        }
+
+    inline socket await_resume()
+        {   // get accepted connection, attached to the listener's reactor
+        (void)_Get_result();
+        this->_MySocket->get_reactor()->attach( this->_MyAccepted );
+        return __impl::move( this->_MyAccepted );
+        }
+
+
+protected:
+    socket _MyAccepted;
+
+    static inline bool _Perform_accept( _Socket_async_operation* _Op ) noexcept
+        {   // attempt to accept incoming connection
+        _Socket_accept_awaitable* _Self = static_cast<_Socket_accept_awaitable*>(_Op);
+        socket_result<socket> _Result = _Self->_MySocket->accept( std::nothrow );
+        while( _Interrupted( _Result.error ) )
+            _Result = _Self->_MySocket->accept( std::nothrow );
+        if( _Result )
+            _Self->_MyAccepted = __impl::move( _Result.value );
+        return _Self->_Complete_status( _Result.error, _Result.would_block );
+        }
+    };
+
+
+// CLASS _Socket_connect_awaitable
+class _Socket_connect_awaitable
+    : public _Socket_timed_awaitable<_Socket_connect_awaitable>
+    {   // socket is closed when the connection attempt times out
+public:
+    inline _Socket_connect_awaitable( socket& _Socket, const socket_address_storage& _Addr ) noexcept
+        : _Socket_timed_awaitable( _Socket, 1, &_Socket_connect_awaitable::_Perform_connect )
+        , _MyAddr( _Addr ), _MyStarted( false )
+        {   // construct connect operation
+        this->_MyClose_on_timeout = true;
+        }
+
+    inline void await_resume() const
+        {   // throw if connection could not be established
+        (void)_Get_result();
+        }
+
+
+protected:
+    socket_address_storage _MyAddr;
+    bool _MyStarted;
+
+    static inline bool _Perform_connect( _Socket_async_operation* _Op ) noexcept
+        {   // start connecting or check if connection has been established
+        _Socket_connect_awaitable* _Self = static_cast<_Socket_connect_awaitable*>(_Op);
+        const _Socket_handle _Handle = _Self->_MySocket->get_native_handle();
+        if( !_Self->_MyStarted )
+            {
+            _Self->_MyStarted = true;
+            socket_result<void> _Result = _Self->_MySocket->connect( _Self->_MyAddr, std::nothrow );
+            if( _Interrupted( _Result.error ) )
+                return false; // interrupted connect continues in the background
+            return _Self->_Complete_status( _Result.error, _Result.would_block );
+            }
+        int _Errval = 0;
+        socklen_t _Errlen = sizeof( _Errval );
+        if( ::getsockopt( _Handle, SOL_SOCKET, SO_ERROR, &_Errval, &_Errlen ) < 0 )
+            _Errval = errno;
+        if( _Errval != 0 )
+            {
+            _Self->_MyError = _Errval;
+            return true;
+            }
+        // socket may report writability before the connect has been started
+        sockaddr_storage _Peer;
+        socklen_t _Peerlen = sizeof( _Peer );
+        return ::getpeername( _Handle, reinterpret_cast<sockaddr*>(&_Peer), &_Peerlen ) == 0;
+        }
+    };
+
+
+inline _Socket_send_awaitable socket::async_send( const void* _Data, size_t _ByteSize, _Socket_send_flags_helper _Flags )
+    {   // send message to the remote host without blocking the thread
+    return _Socket_send_awaitable( *this, _Data, _ByteSize, static_cast<int>(_Flags) );
+    }
+
+inline _Socket_recv_awaitable socket::async_recv( void* _Data, size_t _ByteSize, _Socket_recv_flags_helper _Flags )
+    {   // receive message from the remote host without blocking the thread
+    return _Socket_recv_awaitable( *this, _Data, _ByteSize, static_cast<int>(_Flags) );
+    }
+
+inline _Socket_accept_awaitable socket::async_accept()
+    {   // accept incoming connection from the client without blocking the thread
+    return _Socket_accept_awaitable( *this );
+    }
+
+inline _Socket_connect_awaitable socket::async_connect( const socket_address_storage& _Addr )
+    {   // connect to the remote host without blocking the thread
+    return _Socket_connect_awaitable( *this, _Addr );
+    }
+
+
+// CLASS TEMPLATE _Socketstream_send_awaitable
+template<typename _Elem, typename _Traits>
+class _Socketstream_send_awaitable
+    : public _Socket_timed_awaitable<_Socketstream_send_awaitable<_Elem, _Traits>>
+    {
+public:
+    typedef _Socket_timed_awaitable<_Socketstream_send_awaitable<_Elem, _Traits>> _Mybase;
+
+    inline _Socketstream_send_awaitable( socket& _Socket, const void* _Data, size_t _ByteSize ) noexcept
+        : _Mybase( _Socket, 1, &_Socketstream_send_awaitable::_Perform_send_all )
+        , _MyData( _Data ), _MySize( _ByteSize ), _MySent( 0 ), _MyText()
+        , _MyKind( _Kind_external )
+        {   // construct operation sending caller's data
+        }
+
+    inline _Socketstream_send_awaitable( socket& _Socket, std::basic_string<_Elem, _Traits>&& _Text ) noexcept
+        : _Mybase( _Socket, 1, &_Socketstream_send_awaitable::_Perform_send_all )
+        , _MyData( nullptr ), _MySize( (_Text.length() + 1) * sizeof( _Elem ) ), _MySent( 0 )
+        , _MyText( __impl::move( _Text ) ), _MyKind( _Kind_text )
+        {   // construct operation sending owned text with terminator
+        }
+
+    inline _Socketstream_send_awaitable( socket& _Socket, std::vector<char>&& _Frame ) noexcept
+        : _Mybase( _Socket, 1, &_Socketstream_send_awaitable::_Perform_send_all )
+        , _MyData( nullptr ), _MySize( _Frame.size() ), _MySent( 0 ), _MyText()
+        , _MyFrame( __impl::move( _Frame ) ), _MyKind( _Kind_frame )
+        {   // construct operation sending owned frame
+        }
+
+    template<typename _Ty>
+    inline _Socketstream_send_awaitable( socket& _Socket, const _Ty& _Val,
+            typename std::enable_if<std::is_arithmetic<_Ty>::value>::type* = nullptr ) noexcept
+        : _Mybase( _Socket, 1, &_Socketstream_send_awaitable::_Perform_send_all )
+        , _MyData( nullptr ), _MySize( sizeof( _Ty ) ), _MySent( 0 ), _MyText()
+        , _MyKind( _Kind_raw )
+        {   // construct operation sending copy of raw value
+        static_assert( sizeof( _Ty ) <= sizeof( _MyRaw ), "unsupported value size" );
+        __impl::memcpy( this->_MyRaw, &_Val, sizeof( _Ty ) );
+        }
+
+    inline void await_resume() const
+        {   // throw if the data could not be sent
+        (void)_Get_result();
+        }
+
+
+protected:
+    using _Mybase::_Complete;
+    using _Mybase::_Get_result;
+    using _Mybase::_Interrupted;
+
+    static constexpr int _Kind_external = 0;
+    static constexpr int _Kind_text = 1;
+    static constexpr int _Kind_raw = 2;
+    static constexpr int _Kind_frame = 3;
+
+    const void* _MyData;
+    size_t _MySize;
+    size_t _MySent;
+    std::basic_string<_Elem, _Traits> _MyText;
+    std::vector<char> _MyFrame;
+    int _MyKind;
+    unsigned char _MyRaw[sizeof( long double )];
+
+    _NODISCARD inline const char* _Bytes() const noexcept
+        {   // get data to send, owned buffers are resolved late since the awaitable may be moved
+        if( this->_MyKind == _Kind_text )
+            return reinterpret_cast<const char*>(this->_MyText.c_str());
+        if( this->_MyKind == _Kind_raw )
+            return reinterpret_cast<const char*>(this->_MyRaw);
+        if( this->_MyKind == _Kind_frame )
+            return this->_MyFrame.data();
+        return reinterpret_cast<const char*>(this->_MyData);
+        }
+
+    static inline bool _Perform_send_all( _Socket_async_operation* _Op ) noexcept
+        {   // send remaining data
+        _Socketstream_send_awaitable* _Self = static_cast<_Socketstream_send_awaitable*>(_Op);
+        while( _Self->_MySent < _Self->_MySize )
+            {
+            const socket_result<int> _Result = _Self->_MySocket->send(
+                _Self->_Bytes() + _Self->_MySent, _Self->_MySize - _Self->_MySent, std::nothrow );
+            if( _Interrupted( _Result.error ) )
+                continue;
+            if( !_Result )
+                return _Self->_Complete( _Result );
+            _Self->_MySent += static_cast<size_t>(_Result.value);
+            }
+        return true;
+        }
+    };
+
+
+// CLASS TEMPLATE _Socketstream_recv_awaitable
+template<typename _Elem, typename _Traits, typename _Ty>
+class _Socketstream_recv_awaitable
+    : public _Socket_timed_awaitable<_Socketstream_recv_awaitable<_Elem, _Traits, _Ty>>
+    {   // part of the value may be consumed when the operation times out
+public:
+    typedef _Socket_timed_awaitable<_Socketstream_recv_awaitable<_Elem, _Traits, _Ty>> _Mybase;
+
+    inline _Socketstream_recv_awaitable( basic_socketstream<_Elem, _Traits>& _Stream, _Ty& _Target )
+        : _Mybase( *_Stream._MySocket, 0, &_Socketstream_recv_awaitable::_Perform_recv )
+        , _MyStream( &_Stream ), _MyTarget( &_Target ), _MyScanned( 0 ), _MyText()
+        , _MyLength( _Unknown_length ), _MyReceived( 0 )
+        {   // construct operation receiving value from the stream
+        }
+
+    inline void await_resume()
+        {   // store received value
+        (void)_Get_result();
+        if( !_Is_raw() )
+            { // received text, without terminator
+            _Assign( __impl::move( this->_MyText ) );
+            }
+        }
+
+
+protected:
+    using _Mybase::_Complete;
+    using _Mybase::_Get_result;
+    using _Mybase::_Interrupted;
+
+    basic_socketstream<_Elem, _Traits>* _MyStream;
+    _Ty* _MyTarget;
+    size_t _MyScanned;  // number of elements searched for the terminator
+    std::basic_string<_Elem, _Traits> _MyText;
+    size_t _MyLength;   // size of the framed payload in bytes
+    size_t _MyReceived; // bytes of the framed payload received so far
+
+    static constexpr size_t _Unknown_length = static_cast<size_t>(-1);
+
+    _NODISCARD inline bool _Is_raw() const noexcept
+        {   // check if the value is transmitted as raw bytes
+        return std::is_arithmetic<_Ty>::value
+            && (this->_MyStream->_MyMode & basic_socketstream<_Elem, _Traits>::binary) == basic_socketstream<_Elem, _Traits>::binary;
+        }
+
+    template<typename _Uty = _Ty>
+    inline void _Assign( std::basic_string<_Elem, _Traits>&& _Str,
+            typename std::enable_if<std::is_arithmetic<_Uty>::value>::type* = nullptr )
+        {   // parse text representation of arithmetic value
+        this->_MyStream->_Parse_arithmetic( _Str.data(), _Str.size(), *this->_MyTarget );
+        }
+
+    template<typename _Uty = _Ty>
+    inline void _Assign( std::basic_string<_Elem, _Traits>&& _Str,
+            typename std::enable_if<!std::is_arithmetic<_Uty>::value>::type* = nullptr )
+        {   // store received string
+        (*this->_MyTarget) = __impl::move( _Str );
+        }
+
+    static inline bool _Perform_recv( _Socket_async_operation* _Op ) noexcept
+        {   // receive remaining part of the value
+        _Socketstream_recv_awaitable* _Self = static_cast<_Socketstream_recv_awaitable*>(_Op);
+        if( _Self->_Is_raw() )
+            return _Self->_Recv_raw();
+        return _Self->_MyStream->_Is_framed() ? _Self->_Recv_framed() : _Self->_Recv_terminated();
+        }
+
+    _NODISCARD inline bool _Recv_raw() noexcept
+        {   // receive exactly sizeof( _Ty ) bytes
+        try
+            {
+            while( !this->_MyStream->_Take_raw( this->_MyTarget, sizeof( _Ty ) ) )
+                {
+                const socket_result<int> _Result = this->_MyStream->_Fill_read_buffer();
+                if( _Interrupted( _Result.error ) )
+                    continue;
+                if( !_Result )
+                    return _Complete( _Result );
+                if( _Result.value == 0 )
+                    return _Closed();
+                }
+            return true;
+            }
+        catch( ... )
+            { // allocation failure
+            this->_MyError = ENOMEM;
+            return true;
+            }
+        }
+
+    _NODISCARD inline bool _Recv_terminated() noexcept
+        {   // receive elements up to and including the terminator
+        try
+            {
+            while( !this->_MyStream->_Take_string( this->_MyText, std::numeric_limits<size_t>::max(), this->_MyScanned ) )
+                {
+                const socket_result<int> _Result = this->_MyStream->_Fill_read_buffer();
+                if( _Interrupted( _Result.error ) )
+                    continue;
+                if( !_Result )
+                    return _Complete( _Result );
+                if( _Result.value == 0 )
+                    return _Closed();
+                }
+            return true;
+            }
+        catch( ... )
+            { // allocation failure
+            this->_MyError = ENOMEM;
+            return true;
+            }
+        }
+
+    _NODISCARD inline bool _Recv_framed() noexcept
+        {   // receive length prefix, then the payload directly into the string
+        try
+            {
+            if( this->_MyLength == _Unknown_length )
+                {
+                size_t _Length;
+                while( !this->_MyStream->_Take_length( _Length ) )
+                    {
+                    const socket_result<int> _Result = this->_MyStream->_Fill_read_buffer();
+                    if( _Interrupted( _Result.error ) )
+                        continue;
+                    if( !_Result )
+                        return _Complete( _Result );
+                    if( _Result.value == 0 )
+                        return _Closed();
+                    }
+                this->_MyText.resize( _Length );
+                this->_MyLength = _Length * sizeof( _Elem );
+                this->_MyReceived = this->_MyStream->_Take_some( &this->_MyText[0], this->_MyLength );
+                }
+            char* const _Dest = reinterpret_cast<char*>(&this->_MyText[0]);
+            while( this->_MyReceived < this->_MyLength )
+                {
+                const socket_result<int> _Result = this->_MySocket->recv( _Dest + this->_MyReceived,
+                    __impl::min( this->_MyLength - this->_MyReceived, static_cast<size_t>(std::numeric_limits<int>::max()) ),
+                    std::nothrow );
+                if( _Interrupted( _Result.error ) )
+                    continue;
+                if( !_Result )
+                    return _Complete( _Result );
+                if( _Result.value == 0 )
+                    return _Closed();
+                this->_MyReceived += static_cast<size_t>(_Result.value);
+                }
+            return true;
+            }
+        catch( const std::bad_alloc& )
+            { // allocation failure
+            this->_MyError = ENOMEM;
+            return true;
+            }
+        catch( ... )
+            { // invalid length prefix
+            this->_MyError = EPROTO;
+            return true;
+            }
+        }
+
+    _NODISCARD inline bool _Closed() noexcept
+        {   // connection closed before the whole value has been received
+        this->_MyError = ECONNRESET;
+        return true;
+        }
+    };
+#endif// _LIBSOCK_HAS_COROUTINES
+
+
+#if defined( OS_LINUX )
+// CLASS sharded_listener
+class sharded_listener
+    {   // group of SO_REUSEPORT listeners bound to the same address, one per worker
+public:
+    typedef std::function<void( size_t, socket& )> worker_type;
+
+    sharded_listener( const sharded_listener& ) = delete;
+    sharded_listener& operator=( const sharded_listener& ) = delete;
+
+    inline explicit sharded_listener( const socket_address_info& _Addrinfo, size_t _Shards = 0,
+            size_t _QueueLength = SOMAXCONN, socket_mode _Mode = socket_mode::blocking )
+        : _MyShards()
+        {   // open listeners, by default one per hardware thread
+        if( _Shards == 0 )
+            _Shards = __impl::max<size_t>( std::thread::hardware_concurrency(), 1 );
+        this->_MyShards.reserve( _Shards );
+        for( size_t i = 0; i < _Shards; ++i )
+            {
+            socket _Listener( _Addrinfo, _Mode );
+            _Listener.set_opt( socket_opt::reuse_port, true );
+            _Listener.bind();
+            _Listener.listen( _QueueLength );
+            this->_MyShards.push_back( __impl::move( _Listener ) );
+            }
+        }
+
+    _NODISCARD inline size_t size() const noexcept
+        {   // get number of listeners
+        return this->_MyShards.size();
+        }
+
+    _NODISCARD inline socket& operator[]( size_t _Index ) noexcept
+        {   // get listener of the shard
+        return this->_MyShards[_Index];
+        }
+
+    _NODISCARD inline const socket& operator[]( size_t _Index ) const noexcept
+        {   // get listener of the shard
+        return this->_MyShards[_Index];
+        }
+
+    inline void steer_by_cpu()
+        {   // route each connection to the listener of the shard owning the CPU handling the packet
+        // Kernel distributes connections among the group by hash of the connection by
+        // default. With the BPF program attached, the n-th CPU the calling thread is
+        // allowed to run on belongs to shard n (modulo number of shards), the same CPUs
+        // the workers are pinned to (see run), so connections do not cross cores.
+        const std::vector<int> _Cpus = _Allowed_cpus();
+        const __u32 _Shards = static_cast<__u32>(this->_MyShards.size());
+        std::vector<sock_filter> _Code;
+        _Code.reserve( 2 * _Cpus.size() + 3 );
+        _Code.push_back( sock_filter{ BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<__u32>(SKF_AD_OFF + SKF_AD_CPU) } );
+        for( size_t i = 0; i < _Cpus.size(); ++i )
+            { // if( cpu == _Cpus[i] ) return i % shards;
+            _Code.push_back( sock_filter{ BPF_JMP | BPF_JEQ | BPF_K, 0, 1, static_cast<__u32>(_Cpus[i]) } );
+            _Code.push_back( sock_filter{ BPF_RET | BPF_K, 0, 0, static_cast<__u32>(i % _Shards) } );
+            }
+        // CPUs outside of the allowed set fall back to plain modulo
+        _Code.push_back( sock_filter{ BPF_ALU | BPF_MOD | BPF_K, 0, 0, _Shards } );
+        _Code.push_back( sock_filter{ BPF_RET | BPF_A, 0, 0, 0 } );
+        sock_fprog _Prog;
+        _Prog.len = static_cast<unsigned short>(_Code.size());
+        _Prog.filter = _Code.data();
+        // program is shared by the whole reuseport group
+        _Throw_if_failed( ::setsockopt( this->_MyShards.front().get_native_handle(),
+            SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &_Prog, sizeof( _Prog ) ) );
+        }
+
+    inline void run( worker_type _Worker, bool _Pin_to_cpu = false )
+        {   // run worker on each listener in its own thread and wait for all of them
+        _LIBSOCK_CHECK_ARG_NOT_NULL( _Worker );
+        std::vector<std::thread> _Threads;
+        std::vector<std::exception_ptr> _Errors( this->_MyShards.size() );
+        _Threads.reserve( this->_MyShards.size() );
+        for( size_t i = 0; i < this->_MyShards.size(); ++i )
+            {
+            _Threads.emplace_back( [this, i, &_Worker, &_Errors, _Pin_to_cpu]()
+                {
+                try
+                    {
+                    if( _Pin_to_cpu )
+                        _Pin_current_thread( i, this->_MyShards.size() );
+                    _Worker( i, this->_MyShards[i] );
+                    }
+                catch( ... )
+                    {
+                    _Errors[i] = std::current_exception();
+                    }
+                } );
+            }
+        for( std::thread& _Thread : _Threads )
+            _Thread.join();
+        for( const std::exception_ptr& _Error : _Errors )
+            if( _Error )
+                std::rethrow_exception( _Error );
+        }
+
+protected:
+    std::vector<socket> _MyShards;
+
+    _NODISCARD static inline std::vector<int> _Allowed_cpus()
+        {   // get CPUs the calling thread is allowed to run on, in ascending order
+        cpu_set_t _Allowed;
+        const int _Errval = ::pthread_getaffinity_np( ::pthread_self(), sizeof( _Allowed ), &_Allowed );
+        if( _Errval != 0 )
+            throw socket_exception( _Errval );
+        std::vector<int> _Cpus;
+        for( int _Cpu = 0; _Cpu < CPU_SETSIZE; ++_Cpu )
+            if( CPU_ISSET( _Cpu, &_Allowed ) )
+                _Cpus.push_back( _Cpu );
+        return _Cpus;
+        }
+
+    static inline void _Pin_current_thread( size_t _Index, size_t _Shards )
+        {   // bind calling thread to the allowed CPUs owned by the shard, as steered by steer_by_cpu
+        const std::vector<int> _Cpus = _Allowed_cpus();
+        if( _Cpus.empty() )
+            return;
+        cpu_set_t _Set;
+        CPU_ZERO( &_Set );
+        for( size_t i = _Index; i < _Cpus.size(); i += _Shards )
+            CPU_SET( _Cpus[i], &_Set );
+        if( _Index >= _Cpus.size() )
+            { // more shards than CPUs, the shard receives no steered connections
+            CPU_SET( _Cpus[_Index % _Cpus.size()], &_Set );
+            }
+        const int _Errval = ::pthread_setaffinity_np( ::pthread_self(), sizeof( _Set ), &_Set );
+        if( _Errval != 0 )
+            throw socket_exception( _Errval );
+        }
+    };
+#endif// OS_LINUX
+
+
+// CLASS connection_pool
+class connection_pool
+    {   // connected sockets reused across requests to the same host and service
+public:
+    class lease;
+
+    connection_pool( const connection_pool& ) = delete;
+    connection_pool& operator=( const connection_pool& ) = delete;
+
+    inline explicit connection_pool( const socket_address_info& _Hints, size_t _Spares = 0, size_t _Max_idle = 16,
+            std::chrono::milliseconds _Check_interval = std::chrono::milliseconds( 1000 ) )
+        : _MyHints( _Hints )
+        , _MySpares( _Spares )
+        , _MyMax_idle( __impl::max( _Max_idle, _Spares ) )
+        , _MyInterval( _Check_interval )
+        , _MyEntries()
+        , _MyMutex()
+        , _MyCondition()
+        , _MyStopped( false )
+        , _MyThread()
+        {   // construct pool keeping _Spares connections to each known host ready in the background
+        if( _Spares != 0 )
+            this->_MyThread = std::thread( &connection_pool::_Maintain, this );
+        }
+
+    inline ~connection_pool() noexcept
+        {   // stop background thread and close idle connections, leases must not outlive the pool
+        {
+        std::lock_guard<std::mutex> _Lock( this->_MyMutex );
+        this->_MyStopped = true;
+        }
+        this->_MyCondition.notify_all();
+        if( this->_MyThread.joinable() )
+            this->_MyThread.join();
+        }
+
+    _NODISCARD inline lease acquire( const std::string& _Hostname, const std::string& _Svc_name );
+
+    inline void warm_up( const std::string& _Hostname, const std::string& _Svc_name )
+        {   // register host, so that the spare connections are opened before the first request
+        {
+        std::lock_guard<std::mutex> _Lock( this->_MyMutex );
+        (void)_Get_entry( _Hostname, _Svc_name );
+        }
+        this->_MyCondition.notify_all();
+        }
+
+    _NODISCARD inline size_t idle( const std::string& _Hostname, const std::string& _Svc_name ) const
+        {   // get number of idle connections to the host
+        std::lock_guard<std::mutex> _Lock( this->_MyMutex );
+        const auto _Where = this->_MyEntries.find( std::make_pair( _Hostname, _Svc_name ) );
+        return (_Where != this->_MyEntries.end()) ? _Where->second._Idle.size() : 0;
+        }
+
+    inline void clear()
+        {   // close all idle connections
+        std::vector<socket> _Closed;
+        std::lock_guard<std::mutex> _Lock( this->_MyMutex );
+        for( auto& _Entry : this->_MyEntries )
+            { // sockets are closed after the mutex is released
+            for( socket& _Idle : _Entry.second._Idle )
+                _Closed.push_back( __impl::move( _Idle ) );
+            _Entry.second._Idle.clear();
+            }
+        }
+
+protected:
+    struct _Pool_entry
+        {
+        std::string _Hostname;
+        std::string _Svc_name;
+        std::shared_ptr<std::vector<socket_address_info>> _Addresses; // cached name resolution
+        std::deque<socket> _Idle;
+        size_t _Connecting;
+        std::chrono::steady_clock::time_point _Retry_time;
+        };
+
+    socket_address_info _MyHints;
+    size_t _MySpares;
+    size_t _MyMax_idle;
+    std::chrono::milliseconds _MyInterval;
+    std::map<std::pair<std::string, std::string>, _Pool_entry> _MyEntries;
+    mutable std::mutex _MyMutex;
+    std::condition_variable _MyCondition;
+    bool _MyStopped;
+    std::thread _MyThread;
+
+    _NODISCARD inline _Pool_entry& _Get_entry( const std::string& _Hostname, const std::string& _Svc_name )
+        {   // get entry of the host, mutex must be locked
+        auto _Where = this->_MyEntries.find( std::make_pair( _Hostname, _Svc_name ) );
+        if( _Where == this->_MyEntries.end() )
+            {
+            _Pool_entry _Entry{ _Hostname, _Svc_name, nullptr, std::deque<socket>(), 0,
+                std::chrono::steady_clock::time_point() };
+            _Where = this->_MyEntries.emplace( std::make_pair( _Hostname, _Svc_name ), __impl::move( _Entry ) ).first;
+            }
+        return _Where->second;
+        }
+
+    _NODISCARD inline socket _Connect( _Pool_entry& _Entry )
+        {   // open new connection to the host, mutex must not be locked
+        std::shared_ptr<std::vector<socket_address_info>> _Addresses;
+        {
+        std::lock_guard<std::mutex> _Lock( this->_MyMutex );
+        _Addresses = _Entry._Addresses;
+        }
+        if( _Addresses == nullptr )
+            {
+            _Addresses = std::make_shared<std::vector<socket_address_info>>(
+                get_socket_address_info_list( _Entry._Hostname, _Entry._Svc_name, this->_MyHints ) );
+            }
+        try
+            {
+            socket _Socket = connect_any( *_Addresses );
+            std::lock_guard<std::mutex> _Lock( this->_MyMutex );
+            _Entry._Addresses = _Addresses;
+            return _Socket;
+            }
+        catch( ... )
+            { // resolve the name again on the next attempt
+            std::lock_guard<std::mutex> _Lock( this->_MyMutex );
+            _Entry._Addresses = nullptr;
+            throw;
+            }
+        }
+
+    inline void _Release( _Pool_entry& _Entry, socket&& _Socket ) noexcept
+        {   // return connection to the pool
+        socket _Closed;
+        {
+        std::lock_guard<std::mutex> _Lock( this->_MyMutex );
+        if( !this->_MyStopped && _Entry._Idle.size() < this->_MyMax_idle )
+            _Entry._Idle.push_back( __impl::move( _Socket ) );
+        else // close outside of the lock
+            _Closed = __impl::move( _Socket );
+        }
+        }
+
+    _NODISCARD static inline bool _Is_healthy( const socket& _Socket ) noexcept
+        {   // check if the idle connection can be used
+        // Idle connection has no pending request, any readiness for reading means that
+        // it has been closed or reset by the peer, or that it carries unsolicited data.
+        pollfd _Pollfd{};
+        _Pollfd.fd = _Socket.get_native_handle();
+        _Pollfd.events = POLLIN;
+        return __impl::poll( &_Pollfd, 1, 0 ) == 0;
+        }
+
+    inline void _Maintain() noexcept
+        {   // drop broken idle connections and keep spares connected
+        std::unique_lock<std::mutex> _Lock( this->_MyMutex, std::defer_lock );
+        for( ;; )
+            {
+            try
+                {
+                if( !_Lock.owns_lock() )
+                    _Lock.lock();
+                if( this->_MyStopped )
+                    return;
+                _Maintain_step( _Lock );
+                }
+            catch( ... )
+                { // out of memory or mutex failure, try again after the check interval
+                if( _Lock.owns_lock() )
+                    _Lock.unlock();
+                std::this_thread::sleep_for( this->_MyInterval );
+                }
+            }
+        }
+
+    inline void _Maintain_step( std::unique_lock<std::mutex>& _Lock )
+        {   // check idle connections once and open at most one spare, mutex must be locked
+        const std::chrono::steady_clock::time_point _Now = std::chrono::steady_clock::now();
+        _Pool_entry* _Pending = nullptr;
+        for( auto& _Item : this->_MyEntries )
+            {
+            _Pool_entry& _Entry = _Item.second;
+            _Entry._Idle.erase( std::remove_if( _Entry._Idle.begin(), _Entry._Idle.end(),
+                []( const socket& _Socket ) { return !_Is_healthy( _Socket ); } ), _Entry._Idle.end() );
+            if( _Pending == nullptr
+                && _Entry._Idle.size() + _Entry._Connecting < this->_MySpares
+                && _Entry._Retry_time <= _Now )
+                {
+                _Pending = &_Entry;
+                }
+            }
+        if( _Pending == nullptr )
+            { // nothing to do until a connection is taken or the next check
+            this->_MyCondition.wait_for( _Lock, this->_MyInterval );
+            return;
+            }
+        ++_Pending->_Connecting;
+        _Lock.unlock();
+        socket _Socket;
+        try
+            {
+            _Socket = _Connect( *_Pending );
+            }
+        catch( ... )
+            { // host unavailable, retry after the check interval
+            }
+        _Lock.lock();
+        --_Pending->_Connecting;
+        if( _Socket.get_native_handle() != _Invalid_socket )
+            _Pending->_Idle.push_front( __impl::move( _Socket ) );
+        else
+            _Pending->_Retry_time = std::chrono::steady_clock::now() + this->_MyInterval;
+        }
+    };
+
+
+// CLASS connection_pool::lease
+class connection_pool::lease
+    {   // connection borrowed from the pool, returned when the lease is destroyed
+public:
+    lease( const lease& ) = delete;
+    lease& operator=( const lease& ) = delete;
+
+    inline lease() noexcept
+        : _MyPool( nullptr ), _MyEntry( nullptr ), _MySocket()
+        {   // construct empty lease
+        }
+
+    inline lease( lease&& _Original ) noexcept
+        : lease()
+        {   // take over the connection
+        swap( _Original );
+        }
+
+    inline lease& operator=( lease&& _Original ) noexcept
+        {   // return current connection and take over another one
+        release();
+        swap( _Original );
+        return (*this);
+        }
+
+    inline ~lease() noexcept
+        {   // return connection to the pool
+        release();
+        }
+
+    inline void swap( lease& _Other ) noexcept
+        {   // exchange leases
+        __impl::swap( _MyPool, _Other._MyPool );
+        __impl::swap( _MyEntry, _Other._MyEntry );
+        this->_MySocket.swap( _Other._MySocket );
+        }
+
+    _NODISCARD inline socket& get() noexcept
+        {   // get leased connection
+        return this->_MySocket;
+        }
+
+    _NODISCARD inline socket& operator*() noexcept
+        {   // get leased connection
+        return this->_MySocket;
+        }
+
+    _NODISCARD inline socket* operator->() noexcept
+        {   // get leased connection
+        return &this->_MySocket;
+        }
+
+    _NODISCARD inline explicit operator bool() const noexcept
+        {   // check if the lease holds a connection
+        return this->_MyPool != nullptr;
+        }
+
+    inline void release() noexcept
+        {   // return connection to the pool, it must not have any pending data
+        if( this->_MyPool != nullptr )
+            this->_MyPool->_Release( *this->_MyEntry, __impl::move( this->_MySocket ) );
+        this->_MyPool = nullptr;
+        this->_MyEntry = nullptr;
+        }
+
+    inline void discard() noexcept
+        {   // close connection instead of returning it, e.g. after an error
+        this->_MySocket = socket();
+        this->_MyPool = nullptr;
+        this->_MyEntry = nullptr;
+        }
+
+protected:
+    connection_pool* _MyPool;
+    connection_pool::_Pool_entry* _MyEntry;
+    socket _MySocket;
+
+    inline lease( connection_pool& _Pool, connection_pool::_Pool_entry& _Entry, socket&& _Socket ) noexcept
+        : _MyPool( &_Pool ), _MyEntry( &_Entry ), _MySocket( __impl::move( _Socket ) )
+        {   // construct lease of the connection
+        }
+
+    friend class connection_pool;
+    };
+
+
+inline connection_pool::lease connection_pool::acquire( const std::string& _Hostname, const std::string& _Svc_name )
+    {   // get idle connection to the host or open a new one
+    std::unique_lock<std::mutex> _Lock( this->_MyMutex );
+    _Pool_entry& _Entry = _Get_entry( _Hostname, _Svc_name );
+    while( !_Entry._Idle.empty() )
+        { // most recently used connections are the least likely to be closed by the peer
+        socket _Socket = __impl::move( _Entry._Idle.back() );
+        _Entry._Idle.pop_back();
+        _Lock.unlock();
+        this->_MyCondition.notify_all();
+        if( _Is_healthy( _Socket ) )
+            return lease( *this, _Entry, __impl::move( _Socket ) );
+        _Socket = socket();
+        _Lock.lock();
+        }
+    _Lock.unlock();
+    this->_MyCondition.notify_all();
+    return lease( *this, _Entry, _Connect( _Entry ) );
+    }
+
+
+#if defined( OS_LINUX )
+// STRUCT zerocopy_transfer
+struct zerocopy_transfer
+    {   // result of zerocopy_sender::send
+    int size;           // number of bytes sent
+    bool pending;       // buffer must not be modified until the transfer completes
+    std::uint32_t id;   // identifier of the transfer in completion notifications
+    };
+
+
+// CLASS zerocopy_sender
+class zerocopy_sender
+    {   // sends large buffers without copying them into the kernel (MSG_ZEROCOPY)
+public:
+    typedef std::function<void( std::uint32_t, std::uint32_t, bool )> handler_type;
+
+    zerocopy_sender( const zerocopy_sender& ) = delete;
+    zerocopy_sender& operator=( const zerocopy_sender& ) = delete;
+
+    inline explicit zerocopy_sender( socket& _Socket, size_t _Threshold = 10 * 1024 )
+        : _MySocket( &_Socket )
+        , _MyThreshold( _Threshold )
+        , _MyNext_id( 0 )
+        , _MyBase_id( 0 )
+        , _MyCompleted()
+        , _MyCopied( 0 )
+        {   // enable zero-copy transfers on the socket
+        _Socket.set_opt( socket_opt::zerocopy, true );
+        }
+
+    inline zerocopy_transfer send( const void* _Data, size_t _ByteSize,
+            _Socket_send_flags_helper _Flags = socket_send_flags::none )
+        {   // send data, buffers below the threshold are copied and complete immediately
+        // Pinning pages and processing the notification costs more than copying small
+        // buffers. Zero-copy send also falls back to copying if the kernel runs out of
+        // memory for notifications (ENOBUFS).
+        const int _Handle = this->_MySocket->get_native_handle();
+        if( _ByteSize >= this->_MyThreshold )
+            {
+            const int _Retval = static_cast<int>(::send( _Handle, _Data, _ByteSize,
+                static_cast<int>(_Flags) | MSG_ZEROCOPY | MSG_NOSIGNAL ));
+            if( _Retval >= 0 )
+                {
+                const std::uint32_t _Id = this->_MyNext_id++;
+                this->_MyCompleted.push_back( false );
+                return zerocopy_transfer{ _Retval, true, _Id };
+                }
+            if( errno != ENOBUFS )
+                throw socket_exception( errno );
+            }
+        const int _Retval = _Throw_if_failed( static_cast<int>(::send( _Handle, _Data, _ByteSize,
+            static_cast<int>(_Flags) | MSG_NOSIGNAL )) );
+        return zerocopy_transfer{ _Retval, false, 0 };
+        }
+
+    inline size_t poll_completions( handler_type _Handler = nullptr )
+        {   // process pending completion notifications without blocking
+        // Notifications are read from the socket's error queue. Each one reports range
+        // of completed transfers, and whether the kernel had to copy the data anyway.
+        size_t _Count = 0;
+        for( ;; )
+            {
+            alignas( cmsghdr ) char _Control[CMSG_SPACE( sizeof( sock_extended_err ) ) * 2];
+            msghdr _Message;
+            __impl::memset( &_Message, 0, sizeof( _Message ) );
+            _Message.msg_control = _Control;
+            _Message.msg_controllen = sizeof( _Control );
+            if( ::recvmsg( this->_MySocket->get_native_handle(), &_Message, MSG_ERRQUEUE | MSG_DONTWAIT ) < 0 )
+                {
+                if( errno == EAGAIN || errno == EWOULDBLOCK )
+                    return _Count;
+                if( errno == EINTR )
+                    continue;
+                throw socket_exception( errno );
+                }
+            for( cmsghdr* _Cmsg = CMSG_FIRSTHDR( &_Message ); _Cmsg != nullptr; _Cmsg = CMSG_NXTHDR( &_Message, _Cmsg ) )
+                {
+                sock_extended_err _Error;
+                __impl::memcpy( &_Error, CMSG_DATA( _Cmsg ), sizeof( _Error ) );
+                if( _Error.ee_origin != SO_EE_ORIGIN_ZEROCOPY || _Error.ee_errno != 0 )
+                    continue;
+                const bool _Copied = (_Error.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+                _Complete( _Error.ee_info, _Error.ee_data, _Copied );
+                ++_Count;
+                if( _Handler )
+                    _Handler( _Error.ee_info, _Error.ee_data, _Copied );
+                }
+            }
+        }
+
+    inline bool wait( const zerocopy_transfer& _Transfer, int _Timeout_ms = -1 )
+        {   // wait until the transfer completes, false on timeout
+        // Pending notifications are reported as error condition of the socket.
+        const std::chrono::steady_clock::time_point _Deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds( _Timeout_ms );
+        while( !completed( _Transfer ) )
+            {
+            int _Wait_ms = -1;
+            if( _Timeout_ms >= 0 )
+                {
+                _Wait_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    _Deadline - std::chrono::steady_clock::now() ).count());
+                if( _Wait_ms < 0 )
+                    return false;
+                }
+            pollfd _Pollfd{};
+            _Pollfd.fd = this->_MySocket->get_native_handle();
+            _Pollfd.events = 0;
+            if( __impl::poll( &_Pollfd, 1, _Wait_ms ) < 0 && errno != EINTR )
+                throw socket_exception( errno );
+            (void)poll_completions();
+            }
+        return true;
+        }
+
+    _NODISCARD inline bool completed( const zerocopy_transfer& _Transfer ) const noexcept
+        {   // check if the buffer of the transfer may be reused
+        if( !_Transfer.pending )
+            return true;
+        const std::uint32_t _Offset = _Transfer.id - this->_MyBase_id;
+        return _Offset >= this->_MyCompleted.size() || this->_MyCompleted[_Offset];
+        }
+
+    _NODISCARD inline size_t pending() const noexcept
+        {   // get number of transfers which have not completed yet
+        return static_cast<size_t>(std::count( this->_MyCompleted.begin(), this->_MyCompleted.end(), false ));
+        }
+
+    _NODISCARD inline size_t copied() const noexcept
+        {   // get number of notifications reporting that the kernel copied the data
+        return this->_MyCopied;
+        }
+
+    _NODISCARD inline size_t threshold() const noexcept
+        {   // get minimal size of the buffer sent without copying
+        return this->_MyThreshold;
+        }
+
+    inline void set_threshold( size_t _Threshold ) noexcept
+        {   // set minimal size of the buffer sent without copying
+        this->_MyThreshold = _Threshold;
+        }
+
+protected:
+    socket* _MySocket;
+    size_t _MyThreshold;
+    std::uint32_t _MyNext_id;   // identifier assigned by the kernel to the next transfer
+    std::uint32_t _MyBase_id;   // identifier of the first entry in _MyCompleted
+    std::deque<bool> _MyCompleted;
+    size_t _MyCopied;
+
+    inline void _Complete( std::uint32_t _First, std::uint32_t _Last, bool _Copied ) noexcept
+        {   // mark range of transfers as completed, identifiers wrap around
+        for( std::uint32_t _Id = _First; ; ++_Id )
+            {
+            const std::uint32_t _Offset = _Id - this->_MyBase_id;
+            if( _Offset < this->_MyCompleted.size() )
+                this->_MyCompleted[_Offset] = true;
+            if( _Id == _Last )
+                break;
+            }
+        while( !this->_MyCompleted.empty() && this->_MyCompleted.front() )
+            {
+            this->_MyCompleted.pop_front();
+            ++this->_MyBase_id;
+            }
+        if( _Copied )
+            ++this->_MyCopied;
+        }
+    };
+
+
+// CLASS socket_bridge
+class socket_bridge
+    {   // forwards data in both directions between two connected sockets (splice)
+public:
+    socket_bridge( const socket_bridge& ) = delete;
+    socket_bridge& operator=( const socket_bridge& ) = delete;
+
+    inline socket_bridge( socket& _First, socket& _Second )
+        : _MyDirections()
+        {   // connect sockets, both are switched to non-blocking mode
+        // Each direction moves data through its own pipe, so that data read from one
+        // socket never passes through user memory before it is written to the other one.
+        this->_MyDirections[0]._Source = &_First;
+        this->_MyDirections[0]._Destination = &_Second;
+        this->_MyDirections[1]._Source = &_Second;
+        this->_MyDirections[1]._Destination = &_First;
+        _First.set_nonblocking( true );
+        _Second.set_nonblocking( true );
+        }
+
+    inline size_t pump()
+        {   // move data which is available without blocking, return number of bytes sent
+        // When one of the sockets reports end of the stream, the other one is shut down
+        // for sending once all pending data has been delivered (half-close). Reset or
+        // broken connection closes the directions it affects instead of throwing.
+        return _Pump( this->_MyDirections[0] ) + _Pump( this->_MyDirections[1] );
+        }
+
+    inline bool run( int _Idle_timeout_ms = -1 )
+        {   // forward data until both directions are closed, false on idle timeout
+        for( ;; )
+            {
+            (void)pump();
+            if( closed() )
+                return true;
+            pollfd _Pollfds[2]{};
+            for( int i = 0; i < 2; ++i )
+                {
+                const _Direction& _Dir = this->_MyDirections[i];
+                _Pollfds[i].fd = _Dir._Source->get_native_handle();
+                if( !_Dir._Eof && _Dir._Pending == 0 )
+                    _Pollfds[i].events |= POLLIN;
+                if( this->_MyDirections[1 - i]._Pending > 0 )
+                    _Pollfds[i].events |= POLLOUT;
+                }
+            int _Retval;
+            do
+                {
+                _Retval = __impl::poll( _Pollfds, 2, _Idle_timeout_ms );
+                }
+            while( _Retval < 0 && errno == EINTR );
+            _Throw_if_failed( _Retval );
+            if( _Retval == 0 )
+                return false;
+            for( int i = 0; i < 2; ++i )
+                {
+                if( (_Pollfds[i].revents & POLLNVAL) != 0 )
+                    throw socket_exception( EBADF );
+                if( (_Pollfds[i].revents & (POLLERR | POLLHUP)) != 0 && this->_MyDirections[i]._Eof )
+                    { // source has nothing more to read, errors are left for writes to it
+                    _Drop( this->_MyDirections[1 - i] );
+                    }
+                }
+            }
+        }
+
+    _NODISCARD inline bool closed() const noexcept
+        {   // check if both directions have been closed and all data has been forwarded
+        return this->_MyDirections[0]._Shut && this->_MyDirections[1]._Shut;
+        }
+
+    _NODISCARD inline std::uint64_t first_to_second() const noexcept
+        {   // get number of bytes forwarded from the first socket to the second one
+        return this->_MyDirections[0]._Bytes;
+        }
+
+    _NODISCARD inline std::uint64_t second_to_first() const noexcept
+        {   // get number of bytes forwarded from the second socket to the first one
+        return this->_MyDirections[1]._Bytes;
+        }
+
+protected:
+    struct _Direction
+        {   // state of the transfer in one direction
+        socket* _Source = nullptr;
+        socket* _Destination = nullptr;
+        _Splice_pipe _Pipe;
+        size_t _Pending = 0;        // bytes held in the pipe
+        std::uint64_t _Bytes = 0;   // bytes written to the destination
+        bool _Eof = false;          // source has been closed
+        bool _Shut = false;         // destination has been shut down
+        };
+
+    _Direction _MyDirections[2];
+
+    static inline size_t _Pump( _Direction& _Dir )
+        {   // move data from the source through the pipe to the destination
+        size_t _Moved = 0;
+        while( !_Dir._Shut )
+            {
+            if( _Dir._Pending > 0 )
+                {
+                const ssize_t _Retval = ::splice( _Dir._Pipe._Read, nullptr,
+                    _Dir._Destination->get_native_handle(), nullptr, _Dir._Pending,
+                    SPLICE_F_MOVE | SPLICE_F_NONBLOCK );
+                if( _Retval > 0 )
+                    {
+                    _Dir._Pending -= static_cast<size_t>(_Retval);
+                    _Dir._Bytes += static_cast<std::uint64_t>(_Retval);
+                    _Moved += static_cast<size_t>(_Retval);
+                    continue;
+                    }
+                if( errno == EINTR )
+                    continue;
+                if( errno == EAGAIN || errno == EWOULDBLOCK )
+                    break;
+                if( !_Is_connection_lost( errno ) )
+                    throw socket_exception( errno );
+                _Drop( _Dir ); // destination cannot take the data anymore
+                break;
+                }
+            if( _Dir._Eof )
+                { // all data has been delivered, pass end of the stream
+                try { _Dir._Destination->shutdown( socket::out ); }
+                catch( const socket_exception& ) {} // destination may be gone already
+                _Dir._Shut = true;
+                break;
+                }
+            const ssize_t _Retval = ::splice( _Dir._Source->get_native_handle(), nullptr,
+                _Dir._Pipe._Write, nullptr, _Splice_pipe::_Capacity, SPLICE_F_MOVE | SPLICE_F_NONBLOCK );
+            if( _Retval > 0 )
+                _Dir._Pending += static_cast<size_t>(_Retval);
+            else if( _Retval == 0 )
+                _Dir._Eof = true;
+            else if( errno == EAGAIN || errno == EWOULDBLOCK )
+                break;
+            else if( _Is_connection_lost( errno ) )
+                _Dir._Eof = true; // deliver what has been read, then pass end of the stream
+            else if( errno != EINTR )
+                throw socket_exception( errno );
+            }
+        return _Moved;
+        }
+
+    static inline void _Drop( _Direction& _Dir ) noexcept
+        {   // close the direction, data left in the pipe is discarded
+        _Dir._Pending = 0;
+        _Dir._Eof = true;
+        _Dir._Shut = true;
+        }
+
+    _NODISCARD static inline bool _Is_connection_lost( int _Errval ) noexcept
+        {   // check if error reports reset or otherwise broken connection
+        return (_Errval == ECONNRESET) || (_Errval == EPIPE) || (_Errval == ECONNABORTED)
+            || (_Errval == ETIMEDOUT) || (_Errval == ENOTCONN) || (_Errval == EHOSTUNREACH)
+            || (_Errval == ENETUNREACH) || (_Errval == ENETRESET);
+        }
+    };
+#endif// OS_LINUX
+
+
 }// libsock
 
 #endif// RC_INVOKED
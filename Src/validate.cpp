@@ -6,8 +6,13 @@ struct IUnknown;
 #include "libsock.h"
 using namespace libsock;
 
+#include <cstring>
 #include <string>
 #include <thread>
+#include <vector>
+#if defined( OS_LINUX )
+#include <sys/un.h>
+#endif
 using namespace std;
 
 #ifndef _TRY_BEGIN
@@ -41,7 +46,7 @@ void sock_thread_proc() noexcept
         libsock::socket sock( addrinfo );
         libsock::socketstream sock_stream( sock, socketstream::text );
 
-        sock.connect( *addrinfo.addr );
+        sock.connect( addrinfo.addr );
 
         sock_stream >> g_recv_buffer;
         g_recv_byte_count += (int)strlen( g_recv_buffer ) + 1;
@@ -137,11 +142,1177 @@ int validate_inet_header_packing()
     }
 
 
+#if defined( OS_LINUX )
+// Loopback helpers used by the validation of Linux-only features
+socket_address_info loopback_address( const char* port, socket_type type = socket_type::stream )
+    {
+    socket_address_info hints(
+        socket_address_family::inet,
+        type,
+        (type == socket_type::stream) ? socket_protocol( tcp_socket_protocol() ) : socket_protocol( udp_socket_protocol() ),
+        socket_address_flags::passive );
+
+    return get_socket_address_info( "127.0.0.1", port, hints );
+    }
+
+struct loopback_connection
+    {
+    libsock::socket listener;
+    libsock::socket client;
+    libsock::socket server;
+    };
+
+loopback_connection make_loopback_connection( const char* port )
+    {
+    socket_address_info addrinfo = loopback_address( port );
+
+    loopback_connection conn;
+    conn.listener = libsock::socket( addrinfo );
+    conn.listener.set_opt( socket_opt::reuse_addr, true );
+    conn.listener.bind();
+    conn.listener.listen();
+    conn.client = libsock::socket( addrinfo );
+    conn.client.connect( addrinfo.addr );
+    conn.server = conn.listener.accept();
+    return conn;
+    }
+
+
+int validate_reactor()
+    {
+    loopback_connection conn = make_loopback_connection( "27101" );
+    socket_reactor reactor;
+
+    int received = 0;
+    reactor.add( conn.server, socket_events::in, [&]( _Socket_events_helper )
+        {
+        char buffer[16];
+        received += conn.server.recv( buffer, sizeof( buffer ) );
+        reactor.remove( conn.server );
+        reactor.stop();
+        } );
+
+    conn.client.send( "ping", 4 );
+    reactor.run();
+    if( received != 4 || reactor.size() != 0 )
+        return -101;
+
+    // unregistered sockets are rejected
+    bool thrown = false;
+    try { reactor.remove( conn.client ); }
+    catch( const std::invalid_argument& ) { thrown = true; }
+    if( !thrown )
+        return -102;
+
+    // nothing to dispatch before the timeout
+    reactor.add( conn.client, socket_events::in, []( _Socket_events_helper ) {} );
+    if( reactor.run_once( 10 ) != 0 )
+        return -103;
+    return 0;
+    }
+#endif
+
+
+#if defined( _LIBSOCK_HAS_IO_URING )
+int validate_proactor()
+    {
+    std::unique_ptr<socket_proactor> proactor;
+    try { proactor.reset( new socket_proactor() ); }
+    catch( const socket_exception& ex )
+        { // io_uring may be disabled by the kernel or the sandbox
+        return (ex.code().value() == ENOSYS || ex.code().value() == EPERM) ? 0 : -201;
+        }
+
+    socket_address_info addrinfo = loopback_address( "27102" );
+    libsock::socket listener( addrinfo );
+    listener.set_opt( socket_opt::reuse_addr, true );
+    listener.bind();
+    listener.listen();
+
+    libsock::socket server;
+    char buffer[16] = {};
+    int received = 0;
+    proactor->accept( listener, [&]( socket_completion& accepted )
+        {
+        if( !accepted )
+            return;
+        server = std::move( accepted.accepted );
+        proactor->recv( server, buffer, sizeof( buffer ), [&]( socket_completion& completion )
+            {
+            received = completion ? completion.result : -1;
+            } );
+        } );
+
+    libsock::socket client( addrinfo );
+    bool connected = false;
+    proactor->connect( client, addrinfo.addr, [&]( socket_completion& completion )
+        {
+        connected = static_cast<bool>( completion );
+        if( connected )
+            proactor->send( client, "ping", 4, []( socket_completion& ) {} );
+        } );
+
+    for( int i = 0; i < 50 && received == 0; ++i )
+        proactor->run_once();
+    if( !connected || received != 4 || memcmp( buffer, "ping", 4 ) != 0 )
+        return -202;
+
+    // connection refused is reported by the completion
+    libsock::socket refused( addrinfo );
+    std::error_code error;
+    bool completed = false;
+    listener = libsock::socket();
+    proactor->connect( refused, addrinfo.addr, [&]( socket_completion& completion )
+        {
+        completed = true;
+        error = completion.error;
+        } );
+    for( int i = 0; i < 50 && !completed; ++i )
+        proactor->run_once();
+    if( !completed || error.value() != ECONNREFUSED )
+        return -203;
+    return 0;
+    }
+#endif
+
+
+#if defined( _LIBSOCK_HAS_COROUTINES )
+socket_task echo_once( libsock::socket& sock, int& echoed )
+    {
+    char buffer[16];
+    const int received = co_await sock.async_recv( buffer, sizeof( buffer ) );
+    echoed = co_await sock.async_send( buffer, received );
+    }
+
+socket_task recv_until_closed( libsock::socket& sock, int& error )
+    {
+    try
+        {
+        char buffer[16];
+        (void)co_await sock.async_recv( buffer, sizeof( buffer ) );
+        }
+    catch( const socket_exception& ex )
+        {
+        error = ex.code().value();
+        }
+    catch( const std::exception& )
+        {
+        error = -1;
+        }
+    }
+
+int validate_awaitables()
+    {
+    loopback_connection conn = make_loopback_connection( "27103" );
+    socket_reactor reactor;
+    reactor.attach( conn.server );
+
+    int echoed = 0;
+    echo_once( conn.server, echoed );
+    conn.client.send( "ping", 4 );
+    for( int i = 0; i < 10 && echoed == 0; ++i )
+        reactor.run_once( 100 );
+    char buffer[4];
+    if( echoed != 4 || conn.client.recv( buffer, 4, socket_recv_flags::wait_all ) != 4 )
+        return -301;
+
+    // awaiting requires the socket to be attached
+    int error = 0;
+    conn.client.set_nonblocking( true );
+    recv_until_closed( conn.client, error );
+    if( error != -1 )
+        return -302;
+
+    // closing the socket resumes the waiting coroutine with ECANCELED
+    error = 0;
+    recv_until_closed( conn.server, error );
+    conn.server = libsock::socket();
+    reactor.run_once( 100 );
+    if( error != ECANCELED || reactor.size() != 0 )
+        return -303;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_nothrow_api()
+    {
+    loopback_connection conn = make_loopback_connection( "27104" );
+    conn.server.set_nonblocking( true );
+
+    char buffer[16];
+    socket_result<int> received = conn.server.recv( buffer, sizeof( buffer ), std::nothrow );
+    if( received || !received.would_block || received.error )
+        return -401;
+
+    conn.client.send( "ping", 4 );
+    this_thread::sleep_for( chrono::milliseconds( 10 ) );
+    received = conn.server.recv( buffer, sizeof( buffer ), std::nothrow );
+    if( !received || received.value != 4 )
+        return -402;
+
+    // writing to the reset connection fails the same way in both overloads, without SIGPIPE
+    conn.server = libsock::socket();
+    (void)conn.client.send( "ping", 4, std::nothrow );
+    this_thread::sleep_for( chrono::milliseconds( 10 ) );
+    socket_result<int> sent = conn.client.send( "ping", 4, std::nothrow );
+    if( sent || sent.error.value() != EPIPE )
+        return -403;
+    int error = 0;
+    try { conn.client.send( "ping", 4 ); }
+    catch( const socket_exception& ex ) { error = ex.code().value(); }
+    if( error != EPIPE )
+        return -404;
+
+    libsock::socket closed;
+    if( closed.recv( buffer, sizeof( buffer ), std::nothrow ).error.value() != EBADF )
+        return -405;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_sharded_listener()
+    {
+    socket_address_info addrinfo = loopback_address( "27105" );
+    sharded_listener listener( addrinfo, 2, SOMAXCONN, socket_mode::nonblocking );
+    listener.steer_by_cpu();
+
+    // connection made from the last allowed CPU goes to the shard owning that CPU
+    cpu_set_t allowed;
+    pthread_getaffinity_np( pthread_self(), sizeof( allowed ), &allowed );
+    int cpu = -1;
+    size_t ordinal = 0;
+    for( int i = 0; i < CPU_SETSIZE; ++i )
+        if( CPU_ISSET( i, &allowed ) )
+            {
+            cpu = i;
+            ++ordinal;
+            }
+    const size_t shard = (ordinal - 1) % listener.size();
+
+    thread client_thread( [&]()
+        {
+        cpu_set_t pinned;
+        CPU_ZERO( &pinned );
+        CPU_SET( cpu, &pinned );
+        pthread_setaffinity_np( pthread_self(), sizeof( pinned ), &pinned );
+        libsock::socket client( addrinfo );
+        client.connect( addrinfo.addr );
+        } );
+    client_thread.join();
+    this_thread::sleep_for( chrono::milliseconds( 10 ) );
+    if( !listener[shard].accept( std::nothrow ) || listener[1 - shard].accept( std::nothrow ) )
+        return -501;
+
+    bool thrown = false;
+    try { listener.run( sharded_listener::worker_type() ); }
+    catch( const std::invalid_argument& ) { thrown = true; }
+    if( !thrown )
+        return -502;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_accept_batch()
+    {
+    socket_address_info addrinfo = loopback_address( "27106" );
+    libsock::socket listener( addrinfo, socket_mode::nonblocking );
+    listener.set_opt( socket_opt::reuse_addr, true );
+    listener.bind();
+    listener.listen();
+
+    if( !listener.accept_batch( 8 ).empty() )
+        return -601;
+
+    libsock::socket clients[3];
+    for( libsock::socket& client : clients )
+        {
+        client = libsock::socket( addrinfo );
+        client.connect( addrinfo.addr );
+        }
+    this_thread::sleep_for( chrono::milliseconds( 10 ) );
+    vector<accepted_socket> accepted = listener.accept_batch( 2 );
+    if( accepted.size() != 2
+        || !accepted[0].connection.is_nonblocking()
+        || accepted[0].peer.get_family() != socket_address_family::inet )
+        return -602;
+    if( listener.accept_batch( 8 ).size() != 1 )
+        return -603;
+
+    bool thrown = false;
+    try { (void)listener.accept_batch( 0 ); }
+    catch( const std::invalid_argument& ) { thrown = true; }
+    if( !thrown )
+        return -604;
+    return 0;
+    }
+#endif
+
+
+#if defined( _LIBSOCK_HAS_COROUTINES )
+socket_task recv_with_timeout( libsock::socket& sock, chrono::milliseconds timeout, int& error )
+    {
+    try
+        {
+        char buffer[16];
+        (void)co_await sock.async_recv( buffer, sizeof( buffer ) ).with_timeout( timeout );
+        }
+    catch( const socket_exception& ex )
+        {
+        error = ex.code().value();
+        }
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_timers()
+    {
+    timer_wheel wheel;
+    int fired = 0;
+    socket_timer first( [&fired] { fired += 1; } );
+    socket_timer second( [&fired] { fired += 10; } );
+    wheel.schedule( first, chrono::milliseconds( 5 ) );
+    wheel.schedule( second, chrono::milliseconds( 5 ) );
+    second.cancel();
+    (void)wheel.advance( timer_wheel::clock_type::now() + chrono::milliseconds( 20 ) );
+    if( fired != 1 || first.pending() || !wheel.empty() )
+        return -701;
+
+    // handler throws, the remaining timers stay scheduled and can be cancelled
+    socket_timer failing( [] { throw runtime_error( "handler failed" ); } );
+    wheel.schedule( second, chrono::milliseconds( 5 ) );
+    wheel.schedule( first, chrono::milliseconds( 5 ) );
+    wheel.schedule( failing, chrono::milliseconds( 5 ) );
+    bool failed = false;
+    try { (void)wheel.advance( timer_wheel::clock_type::now() + chrono::milliseconds( 50 ) ); }
+    catch( const runtime_error& ) { failed = true; }
+    if( !failed || failing.pending() || !first.pending() || !second.pending() || wheel.size() != 2 )
+        return -705;
+    second.cancel();
+    (void)wheel.advance( timer_wheel::clock_type::now() + chrono::milliseconds( 50 ) );
+    if( fired != 2 || first.pending() || !wheel.empty() )
+        return -706;
+
+    loopback_connection conn = make_loopback_connection( "27107" );
+    socket_reactor reactor;
+    bool idle = false;
+    reactor.add( conn.server, socket_events::in, []( _Socket_events_helper ) {} );
+    reactor.set_idle_timeout( conn.server, chrono::milliseconds( 20 ), [&idle] { idle = true; } );
+    for( int i = 0; i < 10 && !idle; ++i )
+        reactor.run_once( 20 );
+    if( !idle )
+        return -702;
+    reactor.remove( conn.server );
+
+#if defined( _LIBSOCK_HAS_COROUTINES )
+    int error = 0;
+    reactor.attach( conn.server );
+    recv_with_timeout( conn.server, chrono::milliseconds( 20 ), error );
+    for( int i = 0; i < 10 && error == 0; ++i )
+        reactor.run_once( 20 );
+    if( error != ETIMEDOUT )
+        return -703;
+#endif
+
+    bool thrown = false;
+    try { reactor.set_idle_timeout( conn.client, chrono::milliseconds( 20 ), [] {} ); }
+    catch( const std::invalid_argument& ) { thrown = true; }
+    if( !thrown )
+        return -704;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_connection_pool()
+    {
+    socket_address_info addrinfo = loopback_address( "27108" );
+    libsock::socket listener( addrinfo, socket_mode::nonblocking );
+    listener.set_opt( socket_opt::reuse_addr, true );
+    listener.bind();
+    listener.listen();
+
+    connection_pool pool( addrinfo, 1, 4, chrono::milliseconds( 10 ) );
+    pool.warm_up( "127.0.0.1", "27108" );
+    for( int i = 0; i < 100 && pool.idle( "127.0.0.1", "27108" ) == 0; ++i )
+        this_thread::sleep_for( chrono::milliseconds( 10 ) );
+    if( pool.idle( "127.0.0.1", "27108" ) != 1 )
+        return -801;
+
+    vector<accepted_socket> accepted = listener.accept_batch( 4 );
+    {
+    connection_pool::lease conn = pool.acquire( "127.0.0.1", "27108" );
+    if( !conn || conn->send( "ping", 4 ) != 4 )
+        return -802;
+    }
+    if( pool.idle( "127.0.0.1", "27108" ) == 0 )
+        return -803;
+
+    // nothing listens on the port, connecting fails
+    bool thrown = false;
+    try { (void)pool.acquire( "127.0.0.1", "27199" ); }
+    catch( const socket_exception& ) { thrown = true; }
+    if( !thrown )
+        return -804;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_connect_any()
+    {
+    socket_address_info hints(
+        socket_address_family::inet,
+        socket_type::stream,
+        tcp_socket_protocol() );
+    vector<socket_address_info> addresses = get_socket_address_info_list( "127.0.0.1", "27109", hints );
+    socket_address_info first = get_socket_address_info( "127.0.0.1", "27109", hints );
+    if( addresses.empty()
+        || addresses.front().addr.get_native_sockaddr_size() != first.addr.get_native_sockaddr_size()
+        || memcmp( addresses.front().addr.get_native_sockaddr(), first.addr.get_native_sockaddr(),
+            first.addr.get_native_sockaddr_size() ) != 0 )
+        return -901;
+
+    socket_address_info addrinfo = loopback_address( "27109" );
+    libsock::socket listener( addrinfo );
+    listener.set_opt( socket_opt::reuse_addr, true );
+    listener.bind();
+    listener.listen();
+    libsock::socket client = connect_any( "127.0.0.1", "27109", hints );
+    libsock::socket server = listener.accept();
+    if( client.is_nonblocking() || client.send( "ping", 4 ) != 4 )
+        return -902;
+
+    // nothing listens on the port, every attempt is refused
+    bool thrown = false;
+    try { (void)connect_any( "127.0.0.1", "27199", hints ); }
+    catch( const socket_exception& ) { thrown = true; }
+    if( !thrown )
+        return -903;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_datagram_batch()
+    {
+    socket_address_info addrinfo = loopback_address( "27110", socket_type::datagram );
+    libsock::socket receiver( addrinfo );
+    receiver.bind();
+    libsock::socket sender( addrinfo );
+
+    char payload[3][16] = { "first", "second", "third, too long" };
+    socket_datagram outgoing[3] = {};
+    for( int i = 0; i < 3; ++i )
+        {
+        outgoing[i].data = payload[i];
+        outgoing[i].size = strlen( payload[i] );
+        outgoing[i].address = addrinfo.addr;
+        }
+    if( sender.send_batch( outgoing, 3 ) != 3 )
+        return -1001;
+
+    char buffers[3][8];
+    socket_datagram incoming[3] = {};
+    for( int i = 0; i < 3; ++i )
+        {
+        incoming[i].data = buffers[i];
+        incoming[i].size = sizeof( buffers[i] );
+        }
+    if( receiver.recv_batch( incoming, 3, chrono::milliseconds( 50 ) ) != 3
+        || incoming[1].length != 6 || memcmp( buffers[1], "second", 6 ) != 0 )
+        return -1002;
+    if( incoming[0].truncated || incoming[1].truncated || !incoming[2].truncated )
+        return -1003;
+
+    bool thrown = false;
+    try { (void)receiver.recv_batch( static_cast<socket_datagram*>(nullptr), 3 ); }
+    catch( const std::invalid_argument& ) { thrown = true; }
+    if( !thrown )
+        return -1004;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_vectored_io()
+    {
+    loopback_connection conn = make_loopback_connection( "27111" );
+    unsigned int header = 0xABCD;
+    const char body[] = "payload";
+    if( conn.client.send_vec( { socket_buffer( &header, sizeof( header ) ), socket_buffer( body, 7 ) } ) != 11 )
+        return -1101;
+
+    unsigned int received_header = 0;
+    char received_body[7];
+    socket_buffer buffers[2] = {
+        socket_buffer( &received_header, sizeof( received_header ) ),
+        socket_buffer( received_body, sizeof( received_body ) ) };
+    if( conn.server.recv_vec( buffers, 2, socket_recv_flags::wait_all ) != 11
+        || received_header != 0xABCD || memcmp( received_body, body, 7 ) != 0 )
+        return -1102;
+
+    // nothing is queued, non-blocking receive reports would-block
+    conn.server.set_nonblocking( true );
+    socket_result<int> result = conn.server.recv_vec( buffers, 2, std::nothrow );
+    if( result || !result.would_block )
+        return -1103;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_segmented_send()
+    {
+    socket_address_info addrinfo = loopback_address( "27112", socket_type::datagram );
+    libsock::socket receiver( addrinfo );
+    receiver.bind();
+    libsock::socket sender( addrinfo );
+
+    vector<char> payload( 4000, 'x' );
+    if( sender.send_segmented_to( payload.data(), payload.size(), 1000, addrinfo.addr ) != 4000 )
+        return -1201;
+    char buffer[2000];
+    size_t segment_size = 0;
+    if( receiver.recv_segmented( buffer, sizeof( buffer ), &segment_size ) != 1000 || segment_size != 1000 )
+        return -1202;
+
+    // segment size must be positive and fit into the 16-bit control message
+    int thrown = 0;
+    try { (void)sender.send_segmented_to( payload.data(), payload.size(), 0, addrinfo.addr ); }
+    catch( const std::invalid_argument& ) { ++thrown; }
+    try { (void)sender.send_segmented_to( payload.data(), payload.size(), 0x10000, addrinfo.addr ); }
+    catch( const std::invalid_argument& ) { ++thrown; }
+    if( thrown != 2 )
+        return -1203;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_zerocopy()
+    {
+    loopback_connection conn = make_loopback_connection( "27113" );
+    zerocopy_sender sender( conn.client );
+    zerocopy_transfer small = sender.send( "hi", 2 );
+    if( small.pending || small.size != 2 )
+        return -1301;
+
+    vector<char> payload( 64 * 1024, 'x' );
+    zerocopy_transfer large = sender.send( payload.data(), payload.size() );
+    if( !large.pending || large.size <= 0 )
+        return -1302;
+    vector<char> buffer( payload.size() );
+    for( size_t received = 0; received < 2 + static_cast<size_t>(large.size); )
+        received += static_cast<size_t>(conn.server.recv( buffer.data(), buffer.size() ));
+    if( !sender.wait( large, 2000 ) || !sender.completed( large ) || sender.pending() != 0 )
+        return -1303;
+
+    // socket was never connected
+    libsock::socket unconnected( loopback_address( "27113" ) );
+    zerocopy_sender failing( unconnected );
+    bool thrown = false;
+    try { (void)failing.send( payload.data(), payload.size() ); }
+    catch( const socket_exception& ) { thrown = true; }
+    if( !thrown )
+        return -1304;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+// Creates unlinked temporary file holding the contents
+int make_temporary_file( const vector<char>& contents )
+    {
+    char path[] = "/tmp/libsock-validate-XXXXXX";
+    const int file = mkstemp( path );
+    if( file < 0 )
+        return -1;
+    unlink( path );
+    if( write( file, contents.data(), contents.size() ) != static_cast<ssize_t>(contents.size()) )
+        {
+        close( file );
+        return -1;
+        }
+    return file;
+    }
+
+int validate_send_file()
+    {
+    vector<char> contents( 100000 );
+    for( size_t i = 0; i < contents.size(); ++i )
+        contents[i] = static_cast<char>( 'a' + i % 26 );
+    const int file = make_temporary_file( contents );
+    if( file < 0 )
+        return -1401;
+
+    loopback_connection conn = make_loopback_connection( "27114" );
+    vector<char> received( contents.size() );
+    if( conn.client.send_file( file, 100 ) != contents.size() - 100
+        || conn.server.recv( received.data(), contents.size() - 100, socket_recv_flags::wait_all )
+            != static_cast<int>(contents.size() - 100)
+        || memcmp( received.data(), contents.data() + 100, contents.size() - 100 ) != 0 )
+        {
+        close( file );
+        return -1402;
+        }
+
+    // end of the file is reported as value 0, full socket as would-block
+    conn.client.set_nonblocking( true );
+    socket_result<size_t> result = conn.client.send_file( file, static_cast<off_t>(contents.size()), 10, std::nothrow );
+    if( !result || result.value != 0 )
+        {
+        close( file );
+        return -1403;
+        }
+    while( conn.client.send( contents.data(), contents.size(), std::nothrow ) )
+        ;
+    result = conn.client.send_file( file, 0, contents.size(), std::nothrow );
+    close( file );
+    if( !result.would_block || result.value != 0 )
+        return -1404;
+
+    result = conn.client.send_file( -1, 0, 10, std::nothrow );
+    if( result.error.value() != EBADF )
+        return -1405;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_recv_to_file()
+    {
+    loopback_connection conn = make_loopback_connection( "27115" );
+
+    // destination is not a valid descriptor, received data is dropped
+    conn.client.send( "lost", 4 );
+    socket_result<size_t> result = conn.server.recv_to_file( -1, 0, 64, std::nothrow );
+    if( result || !result.error )
+        return -1501;
+
+    const int file = make_temporary_file( vector<char>() );
+    if( file < 0 )
+        return -1502;
+    conn.client.send( "spliced data", 12 );
+    conn.client.shutdown();
+    size_t stored = 0;
+    while( size_t moved = conn.server.recv_to_file( file, static_cast<off_t>(stored), 64 ) )
+        stored += moved;
+    char contents[12];
+    const bool valid = stored == 12 && pread( file, contents, sizeof( contents ), 0 ) == 12
+        && memcmp( contents, "spliced data", 12 ) == 0;
+    close( file );
+    if( !valid )
+        return -1503;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_socket_bridge()
+    {
+    loopback_connection front = make_loopback_connection( "27116" );
+    libsock::socket upstream( loopback_address( "27116" ) );
+    upstream.connect( loopback_address( "27116" ).addr );
+    libsock::socket backend = front.listener.accept();
+    {
+    socket_bridge bridge( front.server, upstream );
+    front.client.send( "request", 7 );
+    front.client.shutdown( socket::out );
+    char buffer[16];
+    this_thread::sleep_for( chrono::milliseconds( 10 ) );
+    (void)bridge.pump();
+    if( backend.recv( buffer, sizeof( buffer ) ) != 7 || backend.recv( buffer, sizeof( buffer ) ) != 0 )
+        return -1601;
+    backend.send( "reply", 5 );
+    backend.shutdown( socket::out );
+    if( !bridge.run( 1000 ) || front.client.recv( buffer, sizeof( buffer ), socket_recv_flags::wait_all ) != 5
+        || bridge.first_to_second() != 7 || bridge.second_to_first() != 5 )
+        return -1602;
+    }
+
+    // client resets the connection while the backend stays silent
+    front = make_loopback_connection( "27166" );
+    upstream = libsock::socket( loopback_address( "27166" ) );
+    upstream.connect( loopback_address( "27166" ).addr );
+    backend = front.listener.accept();
+    socket_bridge bridge( front.server, upstream );
+    front.client.send( "partial", 7 );
+    linger reset{ 1, 0 };
+    setsockopt( front.client.get_native_handle(), SOL_SOCKET, SO_LINGER, &reset, sizeof( reset ) );
+    front.client = libsock::socket();
+    if( !bridge.run( 1000 ) || !bridge.closed() || bridge.second_to_first() != 0 )
+        return -1603;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_write_buffer()
+    {
+    loopback_connection conn = make_loopback_connection( "27117" );
+    socketstream out( conn.client, socketstream::text );
+    socketstream in( conn.server, socketstream::text );
+    out.set_write_buffer( 64 );
+    out << 1L << string( "hello" );
+    if( out.pending_write_size() != 2 + 6 ) // text with terminators
+        return -1701;
+    out.flush();
+    long number = 0;
+    string text;
+    in >> number >> text;
+    if( out.pending_write_size() != 0 || number != 1 || text != "hello" )
+        return -1702;
+
+    // socket takes only part of the buffer, the rest is kept for the next flush
+    const string chunk( 1024 * 1024, 'x' );
+    out.set_write_buffer( 64 * 1024 * 1024 );
+    for( int i = 0; i < 32; ++i )
+        out << chunk;
+    const size_t total = out.pending_write_size();
+    conn.client.set_nonblocking( true );
+    bool thrown = false;
+    try { out.flush(); }
+    catch( const socket_exception& ) { thrown = true; }
+    const size_t left = out.pending_write_size();
+    if( !thrown || left == 0 || left >= total )
+        return -1703;
+    conn.client.set_nonblocking( false );
+    thread reader( [&conn, &total]
+        {
+        vector<char> buffer( total );
+        (void)conn.server.recv( buffer.data(), total, socket_recv_flags::wait_all );
+        } );
+    out.flush();
+    reader.join();
+    conn.server.set_nonblocking( true );
+    char extra;
+    if( out.pending_write_size() != 0 || conn.server.recv( &extra, 1, std::nothrow ).would_block == false )
+        return -1704;
+
+    // pending data is not sent implicitly, it is dropped with the stream
+    {
+    socketstream dropped( conn.client, socketstream::text );
+    dropped.set_write_buffer( 64 );
+    dropped << string( "dropped" );
+    }
+    if( conn.server.recv( &extra, 1, std::nothrow ).would_block == false )
+        return -1705;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_read_ahead()
+    {
+    loopback_connection conn = make_loopback_connection( "27118" );
+    socketstream in( conn.server );
+    {
+    socketstream out( conn.client );
+    out.set_write_buffer( 1024 );
+    out << string( 300, 'a' ) << "second" << static_cast<short>( 7 ) << flush;
+    }
+
+    // single receive brings all values, the rest is kept for the next extraction
+    string first;
+    in >> first;
+    char second[7];
+    if( first != string( 300, 'a' ) || in.pending_read_size() == 0 )
+        return -1801;
+    short number = 0;
+    in >> second >> number;
+    if( string( second ) != "second" || number != 7 || in.pending_read_size() != 0 )
+        return -1802;
+
+    // connection closed in the middle of the value
+    conn.client.send( "\x05", 1 );
+    conn.client.shutdown( socket::out );
+    long value = 0;
+    bool thrown = false;
+    try { in >> value; }
+    catch( const socket_exception& ) { thrown = true; }
+    if( !thrown )
+        return -1803;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_framed_stream()
+    {
+    // framed values over a local socket, which does not support TCP_CORK
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    const char name[] = "libsock-validate-framed";
+    memcpy( address.sun_path + 1, name, sizeof( name ) - 1 ); // abstract namespace
+    const size_t address_size = offsetof( sockaddr_un, sun_path ) + sizeof( name );
+    libsock::socket listener( socket_address_family::local, socket_type::stream, socket_protocol( 0 ) );
+    listener.bind( &address, address_size );
+    listener.listen();
+    libsock::socket client( socket_address_family::local, socket_type::stream, socket_protocol( 0 ) );
+    client.connect( &address, address_size );
+    libsock::socket server = listener.accept();
+
+    socketstream out( client, socketstream::framed );
+    socketstream in( server, socketstream::framed );
+    out << string( "framed" ) << vector<int>{ 1, 2, 3 } << flush;
+    string text;
+    vector<int> numbers;
+    in >> text >> numbers;
+    if( text != "framed" || numbers != vector<int>{ 1, 2, 3 } )
+        return -1901;
+
+    // value does not fit into the array
+    out << string( "too long" ) << flush;
+    char small[4];
+    bool thrown = false;
+    try { in >> small; }
+    catch( const std::runtime_error& ) { thrown = true; }
+    if( !thrown )
+        return -1902;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_socket_iostream()
+    {
+    loopback_connection conn = make_loopback_connection( "27120" );
+    {
+    socket_iostream out( conn.client );
+    socket_iostream in( conn.server, 16, 16 );
+    out << 42 << ' ' << 3.25 << " word\n" << flush;
+    int number = 0;
+    double real = 0;
+    string word;
+    in >> number >> real >> word;
+    if( number != 42 || real != 3.25 || word != "word" )
+        return -2001;
+    conn.client.shutdown( socket::out );
+    char next;
+    in >> next;
+    if( !in.eof() )
+        return -2002;
+    }
+
+    // socket was never connected, sending fails
+    libsock::socket unconnected( loopback_address( "27120" ) );
+    socket_iostream broken( unconnected );
+    broken << "lost" << flush;
+    if( !broken.bad() )
+        return -2003;
+    return 0;
+    }
+#endif
+
+
+#if defined( _LIBSOCK_HAS_COROUTINES )
+socket_task send_flag_and_letter( socketstream& out, int& error )
+    {
+    try
+        {
+        co_await out.async_send( true );
+        co_await out.async_send( 'x' );
+        }
+    catch( const socket_exception& ex )
+        {
+        error = ex.code().value();
+        }
+    }
+
+socket_task recv_flag_and_letter( socketstream& in, bool& flag, char& letter, int& error )
+    {
+    try
+        {
+        co_await in.async_recv( flag );
+        co_await in.async_recv( letter );
+        }
+    catch( const socket_exception& ex )
+        {
+        error = ex.code().value();
+        }
+    }
+
+int validate_text_awaitables()
+    {
+    loopback_connection conn = make_loopback_connection( "27121" );
+    socket_reactor reactor;
+    reactor.attach( conn.client );
+    reactor.attach( conn.server );
+    socketstream out( conn.client, socketstream::text );
+    socketstream in( conn.client, socketstream::text );
+
+    // bool and characters are formatted like by the standard streams
+    int error = 0;
+    send_flag_and_letter( out, error );
+    for( int i = 0; i < 10 && reactor.run_once( 10 ) > 0; ++i )
+        ;
+    char wire[4];
+    if( error != 0 || conn.server.recv( wire, 4, socket_recv_flags::wait_all ) != 4 || memcmp( wire, "1\0x", 4 ) != 0 )
+        return -2101;
+
+    bool flag = false;
+    char letter = 0;
+    recv_flag_and_letter( in, flag, letter, error );
+    conn.server.send( "1\0z\0", 4 );
+    for( int i = 0; i < 10 && letter == 0 && error == 0; ++i )
+        reactor.run_once( 100 );
+    if( error != 0 || !flag || letter != 'z' )
+        return -2102;
+
+    // connection closed before the value has been received
+    recv_flag_and_letter( in, flag, letter, error );
+    conn.server.shutdown( socket::out );
+    for( int i = 0; i < 10 && error == 0; ++i )
+        reactor.run_once( 100 );
+    if( error == 0 )
+        return -2103;
+
+    // showpoint keeps trailing zeros, other flags are formatted without the stringstream
+    out << showpoint << 1.0 << noshowpoint << showpos << fixed << 1.5;
+    char number[18];
+    int received = 0;
+    conn.server.set_nonblocking( false );
+    for( int i = 0; i < 10 && received < 18; ++i )
+        received += conn.server.recv( number + received, 18 - received );
+    if( received != 18 || memcmp( number, "1.00000\0+1.500000\0", 18 ) != 0 )
+        return -2104;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_ring_buffer()
+    {
+    loopback_connection conn = make_loopback_connection( "27122" );
+    socket_ring_buffer ring( 16, socket_ring_buffer::linear );
+    conn.client.send( "one\ntwo\nthree-and-more", 22 );
+    this_thread::sleep_for( chrono::milliseconds( 10 ) );
+    if( ring.recv( conn.server ) != 16 )
+        return -2201;
+    socket_view first, second;
+    if( !ring.read_until( '\n', first ) || string( first.data(), first.size() ) != "one\n"
+        || !ring.read_until( '\n', second ) || string( second.data(), second.size() ) != "two\n" )
+        return -2202;
+
+    // views are held, space is reused only after release
+    socket_view rest;
+    if( !ring.read( 8, rest ) || ring.free_space() != 0 )
+        return -2203;
+    socket_result<int> result = ring.recv( conn.server, std::nothrow );
+    if( result || result.error.value() != ENOBUFS )
+        return -2204;
+    ring.release( first );
+    ring.release( second );
+    if( ring.recv( conn.server ) != 6 || !ring.read( 6, second ) || string( second.data(), second.size() ) != "d-more"
+        || string( rest.data(), rest.size() ) != "three-an" )
+        return -2205;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_ring_capacity()
+    {
+    loopback_connection conn = make_loopback_connection( "27123" );
+    socket_ring_buffer linear_ring( 60, socket_ring_buffer::linear );
+    socket_ring_buffer mirrored_ring( 60 );
+    if( linear_ring.capacity() != 64 || mirrored_ring.capacity() < 64
+        || (mirrored_ring.capacity() & (mirrored_ring.capacity() - 1)) != 0 )
+        return -2301;
+    conn.client.send( "ring", 4 );
+    this_thread::sleep_for( chrono::milliseconds( 10 ) );
+    socket_view view;
+    if( mirrored_ring.recv( conn.server ) != 4 || !mirrored_ring.read( 4, view ) || string( view.data(), view.size() ) != "ring" )
+        return -2302;
+
+    // capacities which overflow when rounded are rejected
+    int rejected = 0;
+    try { socket_ring_buffer ring( SIZE_MAX, socket_ring_buffer::linear ); }
+    catch( const std::invalid_argument& ) { ++rejected; }
+    try { socket_ring_buffer ring( SIZE_MAX, socket_ring_buffer::mirrored ); }
+    catch( const std::invalid_argument& ) { ++rejected; }
+    socketstream in( conn.server );
+    try { in.set_mirrored_read_buffer( SIZE_MAX ); }
+    catch( const std::invalid_argument& ) { ++rejected; }
+    if( rejected != 3 )
+        return -2303;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_io_buffer_pool()
+    {
+    loopback_connection conn = make_loopback_connection( "27124" );
+    io_buffer_pool pool( 1024 );
+    io_buffer buffer = pool.allocate();
+    conn.client.send( "pooled", 6 );
+    buffer.resize( conn.server.recv( buffer.data(), static_cast<int>(buffer.capacity()) ) );
+    if( buffer.size() != 6 || memcmp( buffer.data(), "pooled", 6 ) != 0 )
+        return -2401;
+
+    // buffer released by another thread goes back to the shard which allocated it
+    char* const data = buffer.data();
+    thread( [&buffer] { buffer.reset(); } ).join();
+    buffer = pool.allocate();
+    if( buffer.data() != data || buffer.size() != 0 )
+        return -2402;
+
+    // buffers allocated by several threads outlive the pool and its shards
+    vector<io_buffer> buffers( 4 );
+    {
+    io_buffer_pool shared_pool( 256 );
+    vector<thread> workers;
+    for( size_t i = 0; i < buffers.size(); ++i )
+        workers.emplace_back( [&shared_pool, &buffers, i] { buffers[i] = shared_pool.allocate(); } );
+    for( thread& worker : workers )
+        worker.join();
+    }
+    for( const io_buffer& pooled : buffers )
+        if( !pooled || pooled.capacity() != 256 )
+            return -2403;
+    buffers.clear();
+
+    int thrown = 0;
+    try { buffer.resize( buffer.capacity() + 1 ); }
+    catch( const std::invalid_argument& ) { ++thrown; }
+    try { io_buffer_pool empty_pool( 0 ); }
+    catch( const std::invalid_argument& ) { ++thrown; }
+    if( thrown != 2 )
+        return -2404;
+    return 0;
+    }
+#endif
+
+
+#if defined( OS_LINUX )
+int validate_address_info_list()
+    {
+    libsock::socket listener( loopback_address( "27125" ) );
+    listener.set_opt( socket_opt::reuse_addr, true );
+    listener.bind();
+    listener.listen();
+
+    // every entry returned by getaddrinfo is kept, whatever its family
+    socket_address_info hints(
+        socket_address_family::unspec,
+        socket_type::stream,
+        tcp_socket_protocol() );
+    vector<socket_address_info> addresses = get_socket_address_info_list( "localhost", "27125", hints );
+    const addrinfo native_hints = hints.get_addrinfo();
+    addrinfo* native = nullptr;
+    if( ::getaddrinfo( "localhost", "27125", &native_hints, &native ) != 0 )
+        return -2501;
+    vector<int> families;
+    for( const addrinfo* entry = native; entry != nullptr; entry = entry->ai_next )
+        families.push_back( entry->ai_family );
+    ::freeaddrinfo( native );
+    if( families.size() != addresses.size() )
+        return -2502;
+    for( size_t i = 0; i < families.size(); ++i )
+        if( static_cast<int>(addresses[i].family) != families[i] )
+            return -2502;
+
+    libsock::socket client = connect_any( "localhost", "27125", hints );
+    libsock::socket server = listener.accept();
+    if( client.send( "list", 4 ) != 4 )
+        return -2503;
+
+    bool thrown = false;
+    try { (void)get_socket_address_info_list( "unresolvable.invalid", "27125", hints ); }
+    catch( const socket_exception& ) { thrown = true; }
+    if( !thrown )
+        return -2504;
+    return 0;
+    }
+#endif
+
+
 int main()
 _TRY_BEGIN
     {
     libsock_scope sockscope;
 
+#if defined( OS_LINUX )
+    if( int err = validate_reactor() )
+        return err;
+    if( int err = validate_nothrow_api() )
+        return err;
+    if( int err = validate_sharded_listener() )
+        return err;
+    if( int err = validate_accept_batch() )
+        return err;
+    if( int err = validate_timers() )
+        return err;
+    if( int err = validate_connection_pool() )
+        return err;
+    if( int err = validate_connect_any() )
+        return err;
+    if( int err = validate_datagram_batch() )
+        return err;
+    if( int err = validate_vectored_io() )
+        return err;
+    if( int err = validate_segmented_send() )
+        return err;
+    if( int err = validate_zerocopy() )
+        return err;
+    if( int err = validate_send_file() )
+        return err;
+    if( int err = validate_recv_to_file() )
+        return err;
+    if( int err = validate_socket_bridge() )
+        return err;
+    if( int err = validate_write_buffer() )
+        return err;
+    if( int err = validate_read_ahead() )
+        return err;
+    if( int err = validate_framed_stream() )
+        return err;
+    if( int err = validate_socket_iostream() )
+        return err;
+    if( int err = validate_ring_buffer() )
+        return err;
+    if( int err = validate_ring_capacity() )
+        return err;
+    if( int err = validate_io_buffer_pool() )
+        return err;
+    if( int err = validate_address_info_list() )
+        return err;
+#endif
+#if defined( _LIBSOCK_HAS_IO_URING )
+    if( int err = validate_proactor() )
+        return err;
+#endif
+#if defined( _LIBSOCK_HAS_COROUTINES )
+    if( int err = validate_awaitables() )
+        return err;
+    if( int err = validate_text_awaitables() )
+        return err;
+#endif
+
     if( int diff = validate_inet_header_packing() )
         return diff;
 